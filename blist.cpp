@@ -0,0 +1,176 @@
+/*
+ * blist.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides a row cache benchmark for the VirtualListWindow class;
+ * it delivers the LVN_ODCACHEHINT and LVN_GETDISPINFO notifications, which
+ * the list view control would send while scrolling, directly to the cache
+ * handlers, over a synthetic data source of one million rows.  No list view
+ * is ever scrolled, or painted, so the timings measure only the cost of the
+ * row cache, and of the data source; they exclude the control's own drawing
+ * and text rendering.  It is built, and run, by "make bench", for the
+ * target host.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <stdio.h>
+#include <string.h>
+#include "wtklite.h"
+#include <commctrl.h>
+
+/* Dimensions of the synthetic list: the number of rows in the source,
+ * the number of columns presented, and the number of rows visible in one
+ * page of the list view.
+ */
+#define BENCH_ROWS	1000000UL
+#define BENCH_COLUMNS	      3
+#define BENCH_PAGE	     40
+
+class SyntheticSource: public WTK::VirtualListSource
+{
+  /* A data source which formats the text of each cell on demand, and
+   * counts the number of cells which have been requested.
+   */
+  public:
+    SyntheticSource(): Requests( 0 ){}
+    unsigned long RowCount(){ return BENCH_ROWS; }
+    void FetchText( unsigned long row, int column, char *buf, size_t len )
+    {
+      ++Requests;
+      switch( column )
+      {
+	case 0: snprintf( buf, len, "Row %lu", row ); break;
+	case 1: snprintf( buf, len, "%08lX", row * 2654435761UL ); break;
+	default: snprintf( buf, len, "%lu bytes", (row * 7919UL) % 1048576UL );
+      }
+    }
+    unsigned long Requests;
+};
+
+class BenchmarkList: public WTK::VirtualListWindow
+{
+  /* A VirtualListWindow, to which the notifications which the list view
+   * control would send, while painting, are delivered directly; the
+   * control itself is bypassed.
+   */
+  public:
+    BenchmarkList( SyntheticSource *source ):
+      WTK::VirtualListWindow( GetModuleHandle( NULL ), source ){}
+
+    void Hint( unsigned long first, unsigned long last )
+    {
+      NMLVCACHEHINT hint; memset( &hint, 0, sizeof( hint ) );
+      hint.hdr.code = LVN_ODCACHEHINT; hint.iFrom = first; hint.iTo = last;
+      OnReflectedNotify( &hint.hdr );
+    }
+
+    void Paint( unsigned long row, int column )
+    {
+      char text[WTK_LIST_TEXT_MAX]; NMLVDISPINFO info;
+      memset( &info, 0, sizeof( info ) ); info.hdr.code = LVN_GETDISPINFO;
+      info.item.mask = LVIF_TEXT; info.item.iItem = row; info.item.iSubItem = column;
+      info.item.pszText = text; info.item.cchTextMax = sizeof( text );
+      OnReflectedNotify( &info.hdr );
+    }
+};
+
+static double Elapsed( LARGE_INTEGER *since )
+{
+  /* Helper to compute the time, in microseconds, since a specified
+   * counter value, and then to update that value.
+   */
+  LARGE_INTEGER now, frequency;
+  QueryPerformanceCounter( &now ); QueryPerformanceFrequency( &frequency );
+  double usec = (double)(now.QuadPart - since->QuadPart) * 1.0e6 / (double)(frequency.QuadPart);
+  *since = now; return usec;
+}
+
+static void Replay( BenchmarkList *list, SyntheticSource *source,
+    const char *name, unsigned long step, bool random
+)
+{
+  /* Replay the notifications for scrolling through the list, by a
+   * specified number of rows per frame, (or to a pseudo-random position
+   * for each frame, as when dragging the scroll thumb), requesting every
+   * visible cell of each frame; report the mean, and worst, time which
+   * the row cache takes per frame.
+   */
+  unsigned long frames = random ? 20000UL : (BENCH_ROWS - BENCH_PAGE) / step;
+  unsigned long top = 0, seed = 1, hits = list->CacheHits(), requests = source->Requests;
+  double total = 0.0, worst = 0.0;
+  LARGE_INTEGER clock; Elapsed( &clock );
+  for( unsigned long frame = 0; frame < frames; frame++ )
+  {
+    if( random ) top = (seed = seed * 1103515245UL + 12345UL) % (BENCH_ROWS - BENCH_PAGE);
+    else top += step;
+    list->Hint( top, top + BENCH_PAGE - 1 );
+    for( unsigned long row = top; row < top + BENCH_PAGE; row++ )
+      for( int column = 0; column < BENCH_COLUMNS; column++ )
+	list->Paint( row, column );
+
+    double usec = Elapsed( &clock ); total += usec;
+    if( usec > worst ) worst = usec;
+  }
+  printf( "%-12s %7lu frames %8.2f us/frame mean %8.2f us max %10.0f rows/s %9lu hits %9lu fetches\n",
+      name, frames, total / frames, worst, frames * BENCH_PAGE * 1.0e6 / total,
+      list->CacheHits() - hits, source->Requests - requests
+    );
+}
+
+int main()
+{
+  /* The list view control is created, (but never shown, nor sent any
+   * message after its columns have been added in the normal manner).
+   */
+  InitCommonControls();
+  HWND parent = CreateWindow( "STATIC", NULL, WS_POPUP, 0, 0, 640, 480,
+      NULL, NULL, GetModuleHandle( NULL ), NULL
+    );
+  SyntheticSource source; BenchmarkList list( &source );
+  list.Create( 1, parent );
+  list.AddColumn( "Name", 100 ); list.AddColumn( "Hash", 100 ); list.AddColumn( "Size", 100 );
+
+  printf( "VirtualListWindow row cache: %lu rows, %d columns, %d rows per page\n",
+      BENCH_ROWS, BENCH_COLUMNS, BENCH_PAGE
+    );
+  Replay( &list, &source, "line", 1, false );
+  Replay( &list, &source, "page", BENCH_PAGE, false );
+  Replay( &list, &source, "thumb", 0, true );
+
+  DestroyWindow( parent );
+  return EXIT_SUCCESS;
+}
+
+/* $RCSfile$: end of file */
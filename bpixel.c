@@ -0,0 +1,131 @@
+/*
+ * bpixel.c
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides a throughput benchmark for the pixel processing
+ * kernels; it reports the rate, in millions of pixels per second, at which
+ * each kernel processes spans of a typical window width, for every
+ * implementation supported by the host processor.  It is portable C, with
+ * no dependency on the MS-Windows API; it is built, and run, by "make
+ * bench", for the target host, or by "make bench-host", for the build
+ * host.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "wtkpixel.h"
+
+#define BENCH_SPAN  1920
+#define BENCH_ROWS  64
+
+static uint32_t dst[BENCH_ROWS][BENCH_SPAN], src[BENCH_ROWS][BENCH_SPAN];
+static uint8_t coverage[BENCH_ROWS][BENCH_SPAN];
+
+enum { FILL, BLEND, BLEND_SOLID, BLEND_MASK, GRADIENT, KERNELS };
+static const char *kernel_name[] =
+{ "fill", "blend", "blend_solid", "blend_mask", "gradient" };
+
+static void run( int kernel, int row )
+{
+  /* Apply one kernel to one row of the benchmark buffers.
+   */
+  switch( kernel )
+  {
+    case FILL:
+      wtk_pixel_fill( dst[row], BENCH_SPAN, 0xFF336699UL ); break;
+    case BLEND:
+      wtk_pixel_blend( dst[row], src[row], BENCH_SPAN ); break;
+    case BLEND_SOLID:
+      wtk_pixel_blend_solid( dst[row], BENCH_SPAN, 0x80402010UL ); break;
+    case BLEND_MASK:
+      wtk_pixel_blend_mask( dst[row], coverage[row], BENCH_SPAN, 0xFF204060UL ); break;
+    case GRADIENT:
+      wtk_pixel_gradient( dst[row], BENCH_SPAN, 0xFF000000UL, 0xFFFFFFFFUL,
+	  0, (0x10000 + BENCH_SPAN - 2) / (BENCH_SPAN - 1)
+	);
+  }
+}
+
+static double rate( int kernel )
+{
+  /* Repeatedly apply a kernel, over all rows of the benchmark buffers,
+   * for at least a quarter of a second; return the mean throughput.
+   */
+  unsigned long passes = 0; clock_t start = clock(), elapsed;
+  do { int row; for( row = 0; row < BENCH_ROWS; row++ ) run( kernel, row ); ++passes; }
+    while( (elapsed = clock() - start) < (CLOCKS_PER_SEC / 4) );
+  return (double)(passes) * BENCH_ROWS * BENCH_SPAN
+    * CLOCKS_PER_SEC / ((double)(elapsed) * 1.0e6);
+}
+
+int main()
+{
+  static const char *implementation_name[] = { "scalar", "SSE2", "AVX2" };
+  unsigned long seed = 12345UL; int row, i, impl, kernel;
+
+  /* Initialise the source pixels, and coverage, with pseudo-random
+   * values, (with translucent pixels, and partial coverage, typical of
+   * anti-aliased content).
+   */
+  for( row = 0; row < BENCH_ROWS; row++ )
+    for( i = 0; i < BENCH_SPAN; i++ )
+    {
+      unsigned a;
+      seed = seed * 1103515245UL + 12345UL; a = (unsigned)((seed >> 16) & 0xFF);
+      src[row][i] = ((uint32_t)(a) << 24) | (a / 2 * 0x010101UL);
+      coverage[row][i] = (uint8_t)(seed >> 24);
+      dst[row][i] = 0xFFFFFFFFUL;
+    }
+
+  printf( "Pixel kernels: Mpixel/s, over spans of %d pixels\n", BENCH_SPAN );
+  printf( "  %-12s", "" );
+  for( impl = WTK_PIXEL_SCALAR; impl <= WTK_PIXEL_AVX2; impl++ )
+    printf( " %9s", implementation_name[impl] );
+  printf( "\n" );
+
+  for( kernel = 0; kernel < KERNELS; kernel++ )
+  {
+    printf( "  %-12s", kernel_name[kernel] );
+    for( impl = WTK_PIXEL_SCALAR; impl <= WTK_PIXEL_AVX2; impl++ )
+    {
+      if( wtk_pixel_select( impl ) == impl ) printf( " %9.0f", rate( kernel ) );
+      else printf( " %9s", "-" );
+    }
+    printf( "\n" );
+  }
+  return EXIT_SUCCESS;
+}
+
+/* $RCSfile$: end of file */
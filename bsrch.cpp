@@ -0,0 +1,141 @@
+/*
+ * bsrch.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides a latency benchmark for the SearchIndex class; it
+ * builds an index of 100,000 pseudo-random entries, then reports the time
+ * taken by each search, as patterns are typed one character at a time, (as
+ * in type-ahead filtering), and the time to build the index itself.  It is
+ * built, and run, by "make bench", for the target host.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <stdio.h>
+#include <string.h>
+#include "wtklite.h"
+
+#define BENCH_ENTRIES  100000UL
+
+static const char *syllable[] =
+{ "Al", "be", "Cor", "da", "el", "Fin", "ga", "ho", "IX", "jo", "ka", "Lum",
+  "mo", "nor", "Os", "pa", "qu", "Ri", "sol", "ta", "UN", "vi", "wex", "yo"
+};
+
+static unsigned long seed = 12345UL;
+static unsigned int Random( unsigned int range )
+{
+  /* A simple, deterministic, pseudo-random number generator.
+   */
+  seed = seed * 1103515245UL + 12345UL;
+  return (unsigned int)((seed >> 16) % range);
+}
+
+static void Compose( char *text )
+{
+  /* Compose the text of an entry, from two to five pseudo-random words,
+   * each of one to three syllables, in mixed case.
+   */
+  *text = '\0';
+  for( unsigned int words = 2 + Random( 4 ); words > 0; words-- )
+  {
+    for( unsigned int n = 1 + Random( 3 ); n > 0; n-- )
+      strcat( text, syllable[Random( sizeof( syllable ) / sizeof( *syllable ) )] );
+    if( words > 1 ) strcat( text, Random( 2 ) ? " " : "_" );
+  }
+}
+
+static double Elapsed( LARGE_INTEGER *since )
+{
+  /* Helper to compute the time, in microseconds, since a specified
+   * counter value, and then to update that value.
+   */
+  LARGE_INTEGER now, frequency;
+  QueryPerformanceCounter( &now ); QueryPerformanceFrequency( &frequency );
+  double usec = (double)(now.QuadPart - since->QuadPart) * 1.0e6 / (double)(frequency.QuadPart);
+  *since = now; return usec;
+}
+
+static void Type( WTK::SearchIndex *index, const char *pattern, int repeat )
+{
+  /* Type a pattern, one character at a time, repeatedly, (clearing it
+   * before each repetition); report the mean and worst search latency,
+   * for each pattern length.
+   */
+  char text[64]; size_t len = strlen( pattern );
+  double total[64], worst[64]; unsigned long matches[64];
+  for( size_t i = 0; i < len; i++ ) total[i] = worst[i] = 0.0;
+
+  LARGE_INTEGER clock;
+  for( int pass = 0; pass < repeat; pass++ )
+  {
+    index->Search( "" );
+    for( size_t i = 0; i < len; i++ )
+    {
+      memcpy( text, pattern, i + 1 ); text[i + 1] = '\0';
+      Elapsed( &clock ); matches[i] = index->Search( text );
+      double usec = Elapsed( &clock ); total[i] += usec;
+      if( usec > worst[i] ) worst[i] = usec;
+    }
+  }
+  for( size_t i = 0; i < len; i++ )
+  {
+    memcpy( text, pattern, i + 1 ); text[i + 1] = '\0';
+    printf( "  %-12s %7lu matches %9.1f us mean %9.1f us max\n",
+	text, matches[i], total[i] / repeat, worst[i]
+      );
+  }
+}
+
+int main()
+{
+  WTK::SearchIndex index; char text[64];
+  LARGE_INTEGER clock; Elapsed( &clock );
+  for( unsigned long key = 0; key < BENCH_ENTRIES; key++ )
+  { Compose( text ); index.Add( key, text ); }
+  printf( "SearchIndex: %lu entries, built in %.1f ms\n", BENCH_ENTRIES, Elapsed( &clock ) / 1000.0 );
+
+  /* Patterns are typed with narrowing, (each keystroke extends the
+   * previous pattern); the final, unrelated, pattern of three or more
+   * characters is searched from the posting lists alone.
+   */
+  Type( &index, "lumnorta", 20 );
+  Type( &index, "Finga be", 20 );
+  Type( &index, "xyz", 20 );
+  Elapsed( &clock ); index.Search( "solvi" );
+  printf( "  %-12s %9.1f us, without narrowing\n", "solvi", Elapsed( &clock ) );
+  return EXIT_SUCCESS;
+}
+
+/* $RCSfile$: end of file */
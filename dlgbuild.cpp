@@ -0,0 +1,191 @@
+/*
+ * dlgbuild.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation for the DialogueTemplate class,
+ * which assembles dialogue templates in memory, for use in place of those
+ * which would otherwise be compiled from a resource script.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <string.h>
+
+#ifdef _WIN32
+#include "wtklite.h"
+#else
+/* When compiled for any other host, (as it is for "make check-host"),
+ * only the template assembly is required; this needs neither windows.h,
+ * nor any other part of the library.
+ */
+#include "wtkdlgtpl.h"
+#endif
+
+/* Offset of the item count field within a DLGTEMPLATE structure; it
+ * follows the "style" and "dwExtendedStyle" fields.
+ */
+#define WTK_DIALOGUE_ITEM_COUNT  (2 * sizeof( DWORD ))
+
+namespace WTK
+{
+  DialogueTemplate::DialogueTemplate( const char *caption,
+      short x, short y, short cx, short cy, unsigned long style,
+      const char *font, unsigned short points
+  ): Buffer( NULL ), Length( 0 ), Limit( 0 )
+  {
+    /* Construct the dialogue header: a DLGTEMPLATE structure, (with
+     * an initially zero item count), followed by the menu and class
+     * fields, (both empty), the caption, and the font specification,
+     * if any; each field is laid out exactly as the DLGTEMPLATE would
+     * be, in a resource file, (i.e. with 2-byte alignment).
+     */
+    if( font != NULL ) style |= DS_SETFONT;
+    AppendLong( style ); AppendLong( 0 ); AppendWord( 0 );
+    AppendWord( x ); AppendWord( y ); AppendWord( cx ); AppendWord( cy );
+    AppendWord( 0 ); AppendWord( 0 ); AppendText( caption );
+    if( font != NULL )
+    {
+      AppendWord( points );
+      AppendText( font );
+    }
+  }
+
+  void *DialogueTemplate::Append( const void *data, size_t len )
+  {
+    /* Helper to append data to the template, expanding the buffer
+     * as required; if no data is specified, we append zero bytes.
+     */
+    if( (Length + len) > Limit )
+    {
+      size_t limit = Limit ? Limit : 256;
+      while( limit < (Length + len) ) limit <<= 1;
+      void *tmp = realloc( (void *)(Buffer), limit );
+      if( tmp == NULL ) throw( runtime_error( "Insufficient memory" ) );
+      Buffer = (unsigned char *)(tmp); Limit = limit;
+    }
+    void *ref = Buffer + Length; Length += len;
+    return (data != NULL) ? memcpy( ref, data, len ) : memset( ref, 0, len );
+  }
+
+  void DialogueTemplate::AppendText( const char *text )
+  {
+    /* Helper to append a NUL terminated string, converted to UTF-16
+     * from the process code page; a NULL string is appended as empty.
+     */
+#   ifdef _WIN32
+    int len;
+    if( (text == NULL) || (*text == '\0') ) AppendWord( 0 );
+    else if( (len = MultiByteToWideChar( CP_ACP, 0, text, -1, NULL, 0 )) > 0 )
+      MultiByteToWideChar( CP_ACP, 0, text, -1,
+	  (WCHAR *)(Append( NULL, len * sizeof( WCHAR ) )), len
+	);
+    else throw( runtime_error( "Dialogue template: invalid text" ) );
+#   else
+    /* On any other host, there is no process code page; we accept only
+     * ASCII text, which widens to UTF-16 without any translation.
+     */
+    if( text == NULL ) AppendWord( 0 );
+    else
+    { WCHAR *ref = (WCHAR *)(Append( NULL, (strlen( text ) + 1) * sizeof( WCHAR ) ));
+      do { if( (*text & 0x80) != 0 )
+	     throw( runtime_error( "Dialogue template: non-ASCII text" ) );
+	 } while( (*ref++ = (WCHAR)(*text++)) != 0 );
+    }
+#   endif
+  }
+
+  void DialogueTemplate::AppendItem( unsigned long style, int id,
+      short x, short y, short cx, short cy
+  )
+  {
+    /* Helper to begin a DLGITEMTEMPLATE; each must be aligned on a
+     * DWORD boundary, so we begin by inserting any necessary padding.
+     */
+    if( (Length & (sizeof( DWORD ) - 1)) != 0 )
+      Append( NULL, sizeof( DWORD ) - (Length & (sizeof( DWORD ) - 1)) );
+
+    AppendLong( style | WS_CHILD | WS_VISIBLE ); AppendLong( 0 );
+    AppendWord( x ); AppendWord( y ); AppendWord( cx ); AppendWord( cy );
+    AppendWord( (unsigned short)(id) );
+  }
+
+  void DialogueTemplate::CompleteItem( const char *text )
+  {
+    /* Helper to complete a DLGITEMTEMPLATE, (which has been started
+     * by AppendItem(), and has had its class field appended); append
+     * the control's text, and an empty creation data field, then update
+     * the item count in the dialogue header.
+     */
+    AppendText( text ); AppendWord( 0 );
+    unsigned short count;
+    memcpy( &count, Buffer + WTK_DIALOGUE_ITEM_COUNT, sizeof( count ) ); ++count;
+    memcpy( Buffer + WTK_DIALOGUE_ITEM_COUNT, &count, sizeof( count ) );
+  }
+
+  DialogueTemplate &DialogueTemplate::Control( unsigned short atom, int id,
+      const char *text, unsigned long style, short x, short y, short cx, short cy
+  )
+  {
+    /* Add a control of a predefined window class, (as identified by
+     * one of the WTK_DIALOGUE_class atoms).
+     */
+    AppendItem( style, id, x, y, cx, cy );
+    AppendWord( 0xFFFF ); AppendWord( atom );
+    CompleteItem( text );
+    return *this;
+  }
+
+  DialogueTemplate &DialogueTemplate::Control( const char *classname, int id,
+      const char *text, unsigned long style, short x, short y, short cx, short cy
+  )
+  {
+    /* Add a control of any registered window class, identified by name.
+     */
+    AppendItem( style, id, x, y, cx, cy );
+    AppendText( classname );
+    CompleteItem( text );
+    return *this;
+  }
+
+#ifdef _WIN32
+  void DialogueTemplate::Register( HINSTANCE app, int ID )
+  {
+    /* Add the assembled template to the GenericDialogue template cache.
+     */
+    GenericDialogue::RegisterTemplate( app, ID, *this );
+  }
+#endif
+}
+
+/* $RCSfile$: end of file */
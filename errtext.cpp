@@ -46,7 +46,7 @@
 
 namespace WTK
 {
-  char error_text::message[256];
+  __thread char error_text::message[256];
 
   error_text::error_text( const char *fmt, ... ) throw()
   {
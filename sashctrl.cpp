@@ -21,7 +21,7 @@
  * derived classes, respectively.
  *
  * Written by Keith Marshall <keithmarshall@users.sourceforge.net>
- * Copyright (C) 2012, 2015, MinGW.org Project.
+ * Copyright (C) 2012, 2015, 2026, MinGW.org Project.
  *
  * ---------------------------------------------------------------------------
  *
@@ -94,7 +94,7 @@ namespace WTK
      * derived HorizontalSashWindowMaker or VerticalSashWindowMaker class.
      */
     WindowClassMaker WindowClassRegistry( AppInstance );
-    WindowClassRegistry.SetCursor( LoadCursor( NULL, CursorStyle() ));
+    WindowClassRegistry.SetCursor( ResourcePrefetcher::Cursor( NULL, CursorStyle() ));
     WindowClassRegistry.Register( ClassName );
   }
 
@@ -193,10 +193,12 @@ namespace WTK
   class MousePositionMapper
   {
     /* This locally declared, all-inline class is used to facilitate 
-     * identification of the co-ordinates of the mouse position.
+     * identification of the co-ordinates of the mouse position; note
+     * that these are signed, since they may be negative, on a monitor
+     * to the left of, or above, the primary monitor.
      */
     private:
-      union { unsigned long v; struct { unsigned short x, y; }; } pos;
+      union { unsigned long v; struct { short x, y; }; } pos;
 
     public:
       MousePositionMapper( unsigned long v ){ pos.v = v; }
@@ -213,10 +215,16 @@ namespace WTK
   const char *HorizontalSashWindowMaker::RegisteredClassName( void )
   {
     /* Helper routine to ensure that the appropriate window class
-     * name is registered on first instantiation of any class object.
+     * name is registered on first instantiation of any class object;
+     * the name is published only after registration has completed, and
+     * concurrent first use, by another thread, waits until it has.
      */
     if( ClassName == NULL )
-      RegisterWindowClassName( ClassName = "HSashCtrl" );
+    {
+      static volatile LONG lock = 0; SpinLock hold( &lock );
+      if( ClassName == NULL )
+      { RegisterWindowClassName( "HSashCtrl" ); ClassName = "HSashCtrl"; }
+    }
     return ClassName;
   }
 
@@ -244,6 +252,23 @@ namespace WTK
     DisplacementFactor = (double)(locate.X() - frame.left) / ScaleFactor;
   }
 
+  void HorizontalSashWindowMaker::
+  Place( const RECT *bounds, RECT *left, RECT *right, int design )
+  {
+    /* Place the sash bar, as a vertical strip of DPI scaled width, which
+     * divides the specified bounds into horizontally adjacent panes.
+     */
+    int thickness = Thickness( design );
+    *left = *right = *bounds;
+    left->right = bounds->left + Displacement( bounds->right - bounds->left ) - thickness / 2;
+    if( left->right > (bounds->right - thickness) ) left->right = bounds->right - thickness;
+    if( left->right < bounds->left ) left->right = bounds->left;
+    right->left = left->right + thickness;
+    MoveWindow( AppWindow, left->right, bounds->top,
+	thickness, bounds->bottom - bounds->top, TRUE
+      );
+  }
+
 # elif defined VSASH_IMPLEMENTATION
   /* This is the case where we are compiling the implementation for
    * the VerticalSashWindowMaker class.
@@ -252,10 +277,16 @@ namespace WTK
   const char *VerticalSashWindowMaker::RegisteredClassName( void )
   {
     /* Helper routine to ensure that the appropriate window class
-     * name is registered on first instantiation of any class object.
+     * name is registered on first instantiation of any class object;
+     * the name is published only after registration has completed, and
+     * concurrent first use, by another thread, waits until it has.
      */
     if( ClassName == NULL )
-      RegisterWindowClassName( ClassName = "VSashCtrl" );
+    {
+      static volatile LONG lock = 0; SpinLock hold( &lock );
+      if( ClassName == NULL )
+      { RegisterWindowClassName( "VSashCtrl" ); ClassName = "VSashCtrl"; }
+    }
     return ClassName;
   }
 
@@ -283,6 +314,23 @@ namespace WTK
     DisplacementFactor = (double)(locate.Y() - frame.top) / ScaleFactor;
   }
 
+  void VerticalSashWindowMaker::
+  Place( const RECT *bounds, RECT *top, RECT *bottom, int design )
+  {
+    /* Place the sash bar, as a horizontal strip of DPI scaled height,
+     * which divides the specified bounds into vertically adjacent panes.
+     */
+    int thickness = Thickness( design );
+    *top = *bottom = *bounds;
+    top->bottom = bounds->top + Displacement( bounds->bottom - bounds->top ) - thickness / 2;
+    if( top->bottom > (bounds->bottom - thickness) ) top->bottom = bounds->bottom - thickness;
+    if( top->bottom < bounds->top ) top->bottom = bounds->top;
+    bottom->top = top->bottom + thickness;
+    MoveWindow( AppWindow, bounds->left, top->bottom,
+	bounds->right - bounds->left, thickness, TRUE
+      );
+  }
+
 # endif
 }
 
@@ -12,7 +12,7 @@
  * StringResource class.
  *
  * Written by Keith Marshall <keithmarshall@users.sourceforge.net>
- * Copyright (C) 2012, MinGW.org Project.
+ * Copyright (C) 2012, 2026, MinGW.org Project.
  *
  * ---------------------------------------------------------------------------
  *
@@ -44,16 +44,22 @@
 #include <string.h>
 #include <stdio.h>
 
-/* MSDN says that the maximum length of any one string resource
- * is 4097 characters; it isn't clear if this limit includes the
- * terminating NUL, so we'll assume we may need one more.
- */
-#define WTK_STRING_RESOURCE_MAX  4098
-
 WTK::StringResource::StringResource( HINSTANCE inst, unsigned int id )
 {
-  /* First, allocate a temporary buffer, of sufficient size to
-   * accommodate a copy of the longest possible string resource.
+  /* When the string has been prefetched, we need only copy it
+   * from the prefetch cache...
+   */
+  WTK::StartupPhase phase( "StringResource" );
+  const char *cached = WTK::ResourcePrefetcher::String( inst, id );
+  if( cached != NULL )
+  {
+    if( (value = strdup( cached )) == NULL )
+      throw( runtime_error( "Insufficient memory" ) );
+    return;
+  }
+
+  /* ...otherwise, allocate a temporary buffer, of sufficient size
+   * to accommodate a copy of the longest possible string resource.
    */
   char *tmp; value = NULL;
   if( (tmp = (char *)(malloc( WTK_STRING_RESOURCE_MAX ))) == NULL )
@@ -0,0 +1,128 @@
+/*
+ * tdlgtpl.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides a test for the DialogueTemplate class; it assembles
+ * a small dialogue, and compares the result, byte for byte, with the layout
+ * which a resource compiler would produce for the equivalent DIALOG
+ * resource script.  It is built by "make check", for the target host, and
+ * also by "make check-host", for any little-endian build host; the code
+ * page conversion check is performed only on the target host.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <stdio.h>
+#include <string.h>
+#ifdef _WIN32
+#include "wtklite.h"
+#else
+#include "wtkdlgtpl.h"
+#endif
+
+/* Each expected template is described as a sequence of 16-bit words,
+ * (in the little-endian order of every Windows host); DWORD values are
+ * split into their low and high halves.
+ */
+#define DW( value )  (unsigned short)((value) & 0xFFFF), (unsigned short)((value) >> 16)
+
+static const unsigned short expected[] =
+{ /* DLGTEMPLATE: style, extended style, item count, and placement...
+   */
+  DW( WS_POPUP | WS_CAPTION | DS_SETFONT ), DW( 0 ), 2, 10, 20, 120, 60,
+
+  /* ...no menu, default class, caption "Test", and font "MS Shell Dlg"
+   * at 8 points; (the header ends on a DWORD boundary).
+   */
+  0, 0, 'T', 'e', 's', 't', 0,
+  8, 'M', 'S', ' ', 'S', 'h', 'e', 'l', 'l', ' ', 'D', 'l', 'g', 0,
+
+  /* First DLGITEMTEMPLATE: an "OK" push button, ID 1...
+   */
+  DW( BS_PUSHBUTTON | WS_TABSTOP | WS_CHILD | WS_VISIBLE ), DW( 0 ),
+  35, 40, 50, 14, 1, 0xFFFF, WTK_DIALOGUE_BUTTON, 'O', 'K', 0, 0,
+
+  /* ...which ends on a WORD boundary, so the second, a static label,
+   * ID 2, with a NULL caption, is preceded by one word of padding.
+   */
+  0,
+  DW( SS_LEFT | WS_CHILD | WS_VISIBLE ), DW( 0 ),
+  5, 5, 110, 8, 2, 0xFFFF, WTK_DIALOGUE_STATIC, 0, 0
+};
+
+static int failures = 0;
+
+static void check( const char *what, bool condition )
+{
+  /* Report the outcome of one test assertion.
+   */
+  printf( "%s: %s\n", condition ? "PASS" : "FAIL", what );
+  if( ! condition ) ++failures;
+}
+
+int main()
+{
+  WTK::DialogueTemplate dialogue( "Test", 10, 20, 120, 60, WS_POPUP | WS_CAPTION );
+  dialogue.Button( 1, "OK", 35, 40, 50, 14 ).Label( 2, NULL, 5, 5, 110, 8 );
+
+  const unsigned char *image = (const unsigned char *)(dialogue.Data());
+  check( "template size", dialogue.Size() == sizeof( expected ) );
+  check( "template content", (dialogue.Size() == sizeof( expected ))
+      && (memcmp( image, expected, sizeof( expected ) ) == 0)
+    );
+
+  /* Text is converted from the process code page; where that is the
+   * Western European code page, the euro sign is 0x80, (not U+0080).
+   */
+# ifdef _WIN32
+  if( GetACP() == 1252 )
+  {
+    WTK::DialogueTemplate euro( "\x80", 0, 0, 10, 10, WS_POPUP, NULL );
+    unsigned short caption;
+    memcpy( &caption, (const unsigned char *)(euro.Data()) + 22, sizeof( caption ) );
+    check( "code page conversion", caption == 0x20AC );
+  }
+# else
+  /* Elsewhere, there is no process code page; text which is not pure
+   * ASCII must be rejected, rather than mistranslated.
+   */
+  bool rejected = false;
+  try { WTK::DialogueTemplate euro( "\x80", 0, 0, 10, 10, WS_POPUP, NULL ); }
+  catch( WTK::runtime_error & ){ rejected = true; }
+  check( "non-ASCII text rejected", rejected );
+# endif
+  return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* $RCSfile$: end of file */
@@ -0,0 +1,240 @@
+/*
+ * tpixel.c
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides a pixel exact test for the pixel processing kernels;
+ * each kernel is checked, for every implementation supported by the host
+ * processor, over spans of every length from zero to 67 pixels, (so that
+ * every combination of SIMD blocks and scalar residue is exercised),
+ * against an independent reference computation.  It is portable C, with
+ * no dependency on the MS-Windows API; it is built, and run, by "make
+ * check", for the target host, or by "make check-host", for the build
+ * host.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "wtkpixel.h"
+
+#define TEST_SPAN_MAX  67
+#define TEST_GUARD	4
+#define TEST_SENTINEL  0xDEADBEEFUL
+
+static unsigned long seed = 12345UL;
+static unsigned random_value( unsigned range )
+{
+  /* A simple, deterministic, pseudo-random number generator.
+   */
+  seed = seed * 1103515245UL + 12345UL;
+  return (unsigned)((seed >> 16) % range);
+}
+
+static uint32_t random_pixel( void )
+{
+  /* Generate a premultiplied pixel; fully transparent, and fully opaque
+   * pixels are favoured, since the kernels must treat them exactly.
+   */
+  unsigned a, shift; uint32_t pixel;
+  switch( random_value( 4 ) )
+  { case 0: a = 0; break; case 1: a = 255; break; default: a = random_value( 256 ); }
+  for( pixel = (uint32_t)(a) << 24, shift = 0; shift < 24; shift += 8 )
+    pixel |= (uint32_t)(random_value( a + 1 )) << shift;
+  return pixel;
+}
+
+/* Reference computations; these follow the documented arithmetic, (i.e.
+ * division by 255 rounded to nearest, saturating component sums, and 8.8
+ * interpolation weights), rather than the kernels' own formulation.
+ */
+static unsigned ref_div255( unsigned x ){ return (2 * x + 255) / 510; }
+
+static uint32_t ref_over( uint32_t d, uint32_t s )
+{
+  unsigned ia = 255 - (s >> 24), shift; uint32_t result = 0;
+  for( shift = 0; shift < 32; shift += 8 )
+  {
+    unsigned c = ((s >> shift) & 0xFF) + ref_div255( ((d >> shift) & 0xFF) * ia );
+    result |= (uint32_t)((c > 255) ? 255 : c) << shift;
+  }
+  return result;
+}
+
+static uint32_t ref_scale( uint32_t s, unsigned m )
+{
+  unsigned shift; uint32_t result = 0;
+  for( shift = 0; shift < 32; shift += 8 )
+    result |= (uint32_t)(ref_div255( ((s >> shift) & 0xFF) * m )) << shift;
+  return result;
+}
+
+static uint32_t ref_mix( uint32_t from, uint32_t to, int32_t position )
+{
+  unsigned w, shift; uint32_t result = 0;
+  w = (position <= 0) ? 0 : (position >= 0x10000) ? 256 : (unsigned)(position) / 256;
+  for( shift = 0; shift < 32; shift += 8 )
+    result |= (uint32_t)((((from >> shift) & 0xFF) * (256 - w)
+	  + ((to >> shift) & 0xFF) * w + 128) / 256) << shift;
+  return result;
+}
+
+static int failures = 0, checks = 0;
+static const char *implementation_name[] = { "scalar", "SSE2", "AVX2" };
+
+static void check
+( int impl, const char *kernel, size_t len, const uint32_t *actual, const uint32_t *expected )
+{
+  /* Compare a span, and its trailing guard pixels, with the expected
+   * result; report the first mismatch, if any.
+   */
+  size_t i;
+  for( ++checks, i = 0; i < len + TEST_GUARD; i++ )
+    if( actual[i] != expected[i] )
+    {
+      printf( "FAIL: %s %s, length %u, pixel %u: 0x%08lX, expected 0x%08lX\n",
+	  implementation_name[impl], kernel, (unsigned)(len), (unsigned)(i),
+	  (unsigned long)(actual[i]), (unsigned long)(expected[i])
+	);
+      ++failures; return;
+    }
+}
+
+static void test_span( int impl, size_t len, size_t offset )
+{
+  /* Exercise every kernel over a single span, starting at a specified
+   * pixel offset, (to vary its alignment), within its buffer.
+   */
+  uint32_t buffer[TEST_SPAN_MAX + TEST_GUARD + 4], expected[TEST_SPAN_MAX + TEST_GUARD];
+  uint32_t src[TEST_SPAN_MAX], original[TEST_SPAN_MAX], *dst = buffer + offset;
+  uint8_t coverage[TEST_SPAN_MAX + 4];
+  uint32_t colour = random_pixel(), from = random_pixel(), to = random_pixel();
+  int32_t origin = (int32_t)(random_value( 0x14000 )) - 0x2000;
+  int32_t step = (int32_t)(random_value( 0x1000 )) - 0x800;
+  size_t i;
+
+  for( i = 0; i < len; i++ )
+  {
+    original[i] = random_pixel(); src[i] = random_pixel();
+    switch( random_value( 4 ) )
+    {
+      case 0: coverage[offset + i] = 0; break;
+      case 1: coverage[offset + i] = 255; break;
+      default: coverage[offset + i] = (uint8_t)(random_value( 256 ));
+    }
+  }
+# define RESET()  for( i = 0; i < len + TEST_GUARD; i++ ) \
+    dst[i] = expected[i] = (i < len) ? original[i] : TEST_SENTINEL
+
+  RESET(); wtk_pixel_fill( dst, len, colour );
+  for( i = 0; i < len; i++ ) expected[i] = colour;
+  check( impl, "fill", len, dst, expected );
+
+  RESET(); wtk_pixel_blend( dst, src, len );
+  for( i = 0; i < len; i++ ) expected[i] = ref_over( original[i], src[i] );
+  check( impl, "blend", len, dst, expected );
+
+  RESET(); wtk_pixel_blend_solid( dst, len, colour );
+  for( i = 0; i < len; i++ ) expected[i] = ref_over( original[i], colour );
+  check( impl, "blend_solid", len, dst, expected );
+
+  RESET(); wtk_pixel_blend_mask( dst, coverage + offset, len, colour );
+  for( i = 0; i < len; i++ ) if( coverage[offset + i] )
+    expected[i] = ref_over( original[i], ref_scale( colour, coverage[offset + i] ) );
+  check( impl, "blend_mask", len, dst, expected );
+
+  RESET(); wtk_pixel_gradient( dst, len, from, to, origin, step );
+  for( i = 0; i < len; i++ ) expected[i] = ref_mix( from, to, origin + (int32_t)(i) * step );
+  check( impl, "gradient", len, dst, expected );
+# undef RESET
+}
+
+static void prepare( uint32_t *dst, uint32_t *expected, uint32_t initial, uint32_t result )
+{
+  /* Helper to initialise a single pixel span, and its guard pixels, for
+   * comparison with a known result.
+   */
+  int i;
+  for( i = 0; i < 1 + TEST_GUARD; i++ )
+    dst[i] = expected[i] = (i == 0) ? initial : TEST_SENTINEL;
+  expected[0] = result;
+}
+
+static void test_known_values( int impl )
+{
+  /* A few hand computed results, to guard against any error shared by
+   * the kernels and the reference computations.
+   */
+  uint32_t dst[1 + TEST_GUARD], expected[1 + TEST_GUARD]; uint8_t half = 128;
+
+  prepare( dst, expected, 0xFF000000UL, 0xFF808080UL );
+  wtk_pixel_blend_solid( dst, 1, 0x80808080UL );
+  check( impl, "blend_solid (known)", 1, dst, expected );
+
+  prepare( dst, expected, 0xFFFFFFFFUL, 0xFF7F7F7FUL );
+  wtk_pixel_blend_mask( dst, &half, 1, 0xFF000000UL );
+  check( impl, "blend_mask (known)", 1, dst, expected );
+
+  prepare( dst, expected, 0x12345678UL, 0xFFFFFFFFUL );
+  wtk_pixel_gradient( dst, 1, 0xFF000000UL, 0xFFFFFFFFUL, 0x10000, 0 );
+  check( impl, "gradient end (known)", 1, dst, expected );
+
+  prepare( dst, expected, 0x12345678UL, 0xFF808080UL );
+  wtk_pixel_gradient( dst, 1, 0xFF000000UL, 0xFFFFFFFFUL, 0x8000, 0 );
+  check( impl, "gradient midpoint (known)", 1, dst, expected );
+}
+
+int main()
+{
+  int impl, tested = 0;
+  for( impl = WTK_PIXEL_SCALAR; impl <= WTK_PIXEL_AVX2; impl++ )
+  {
+    size_t len;
+    if( wtk_pixel_select( impl ) != impl )
+    {
+      printf( "SKIP: %s is not supported on this host\n", implementation_name[impl] );
+      continue;
+    }
+    test_known_values( impl );
+    for( len = 0; len <= TEST_SPAN_MAX; len++ )
+    {
+      test_span( impl, len, 0 );
+      test_span( impl, len, 1 + len % 3 );
+    }
+    ++tested;
+  }
+  printf( "%s: %d spans, over %d implementations\n", failures ? "FAIL" : "PASS", checks, tested );
+  return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* $RCSfile$: end of file */
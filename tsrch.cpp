@@ -0,0 +1,185 @@
+/*
+ * tsrch.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides a test for the SearchIndex class; it builds an index
+ * of 100,000 pseudo-random entries, then verifies the result of each search,
+ * (as a pattern is extended, shortened and replaced, and as entries are
+ * replaced and removed), against a naive case insensitive scan of every
+ * entry.  It is built, and run, by "make check", for the target host.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include "wtklite.h"
+
+#define TEST_ENTRIES  100000UL
+
+static const char *syllable[] =
+{ "Al", "be", "Cor", "da", "el", "Fin", "ga", "ho", "IX", "jo", "ka", "Lum",
+  "mo", "nor", "Os", "pa", "qu", "Ri", "sol", "ta", "UN", "vi", "wex", "yo"
+};
+
+static unsigned long seed = 12345UL;
+static unsigned int Random( unsigned int range )
+{
+  /* A simple, deterministic, pseudo-random number generator.
+   */
+  seed = seed * 1103515245UL + 12345UL;
+  return (unsigned int)((seed >> 16) % range);
+}
+
+static void Compose( char *text )
+{
+  /* Compose the text of an entry, from two to five pseudo-random words,
+   * each of one to three syllables, in mixed case.
+   */
+  *text = '\0';
+  for( unsigned int words = 2 + Random( 4 ); words > 0; words-- )
+  {
+    for( unsigned int n = 1 + Random( 3 ); n > 0; n-- )
+      strcat( text, syllable[Random( sizeof( syllable ) / sizeof( *syllable ) )] );
+    if( words > 1 ) strcat( text, Random( 2 ) ? " " : "_" );
+  }
+}
+
+/* The reference model: the text of each entry, and the order in which
+ * live entries were (most recently) added, as the index will report them;
+ * each key's position in that order is also recorded.
+ */
+static char (*model)[64];
+static unsigned long *order, *position, model_count = 0;
+
+static bool Contains( const char *text, const char *pattern )
+{
+  /* Naive case insensitive substring test.
+   */
+  size_t len = strlen( pattern );
+  for( ; *text; text++ )
+  {
+    size_t i = 0;
+    while( (i < len) && tolower( (unsigned char)(text[i]) ) == tolower( (unsigned char)(pattern[i]) ) )
+      ++i;
+    if( i == len ) return true;
+  }
+  return len == 0;
+}
+
+static int failures = 0, searches = 0;
+
+static void Verify( WTK::SearchIndex *index, const char *pattern )
+{
+  /* Compare the result of one search, key by key, with that of the
+   * reference model.
+   */
+  unsigned long count = index->Search( pattern ), expected = 0;
+  bool same = true; ++searches;
+  for( unsigned long i = 0; i < model_count; i++ )
+    if( (order[i] != ~0UL) && Contains( model[order[i]], pattern ) )
+    {
+      if( (expected >= count) || (index->Match( expected ) != order[i]) ) same = false;
+      ++expected;
+    }
+  if( ! same || (count != expected) )
+  {
+    printf( "FAIL: \"%s\": %lu matches, expected %lu\n", pattern, count, expected );
+    ++failures;
+  }
+}
+
+static void Add( WTK::SearchIndex *index, unsigned long key, const char *text )
+{
+  /* Add, or replace, an entry, in both the index and the model.
+   */
+  if( position[key] != ~0UL ) order[position[key]] = ~0UL;
+  strcpy( model[key], text ); order[position[key] = model_count++] = key;
+  index->Add( key, text );
+}
+
+static void Remove( WTK::SearchIndex *index, unsigned long key )
+{
+  /* Remove an entry, from both the index and the model.
+   */
+  if( position[key] != ~0UL ) order[position[key]] = ~0UL;
+  position[key] = ~0UL;
+  index->Remove( key );
+}
+
+static void Type( WTK::SearchIndex *index, const char *pattern )
+{
+  /* Simulate typing a pattern, one character at a time, then deleting
+   * it again, verifying the result after each keystroke.
+   */
+  char text[64]; size_t len = strlen( pattern );
+  for( size_t i = 1; i <= len; i++ ) { memcpy( text, pattern, i ); text[i] = '\0'; Verify( index, text ); }
+  while( len-- > 0 ) { text[len] = '\0'; Verify( index, text ); }
+}
+
+int main()
+{
+  model = (char (*)[64])(malloc( TEST_ENTRIES * sizeof( *model ) ));
+  order = (unsigned long *)(malloc( 2 * TEST_ENTRIES * sizeof( *order ) ));
+  position = (unsigned long *)(malloc( TEST_ENTRIES * sizeof( *position ) ));
+  if( (model == NULL) || (order == NULL) || (position == NULL) ) return EXIT_FAILURE;
+  memset( position, 0xFF, TEST_ENTRIES * sizeof( *position ) );
+
+  WTK::SearchIndex index; char text[64];
+  for( unsigned long key = 0; key < TEST_ENTRIES; key++ ) { Compose( text ); Add( &index, key, text ); }
+
+  Type( &index, "lumnor" ); Type( &index, "IXQU" ); Type( &index, "a_b" );
+  Type( &index, "solta vi" ); Verify( &index, "zzz" ); Verify( &index, "" );
+
+  /* Replace some entries, (each of which then moves to the end of the
+   * result order), while a narrowed search is current...
+   */
+  Verify( &index, "ta" );
+  for( unsigned long key = 0; key < TEST_ENTRIES; key += 97 ) { Compose( text ); Add( &index, key, text ); }
+  Verify( &index, "tal" ); Type( &index, "yoel" );
+
+  /* ...then remove more than half of them, to provoke compaction.
+   */
+  Verify( &index, "mo" );
+  for( unsigned long key = 0; key < TEST_ENTRIES; key++ )
+    if( (key % 3) != 0 ) Remove( &index, key );
+  Verify( &index, "mol" ); Type( &index, "kaho" ); Type( &index, "Finga" );
+
+  printf( "%s: %d searches over %lu entries\n", failures ? "FAIL" : "PASS", searches, TEST_ENTRIES );
+  free( (void *)(model) ); free( (void *)(order) ); free( (void *)(position) );
+  return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* $RCSfile$: end of file */
@@ -12,7 +12,7 @@
  * which is used by all window classes derived from GenericWindow.
  *
  * Written by Keith Marshall <keithmarshall@users.sourceforge.net>
- * Copyright (C) 2012, MinGW.org Project.
+ * Copyright (C) 2012, 2026, MinGW.org Project.
  *
  * ---------------------------------------------------------------------------
  *
@@ -113,11 +113,15 @@ namespace WTK
       OnEventCase( WM_MOUSEMOVE,      OnMouseMove( w_param ) );
       OnEventCase( WM_LBUTTONDOWN,    OnLeftButtonDown() );
       OnEventCase( WM_LBUTTONUP,      OnLeftButtonUp() );
-      OnEventCase( WM_NOTIFY,         OnNotify( w_param, l_param ) );
+      case WM_NOTIFY: return DispatchNotification( w_param, l_param );
       OnEventCase( WM_SIZE,           OnSize( w_param, SplitWord(l_param) ) );
       OnEventCase( WM_HSCROLL,        OnHorizontalScroll( SplitWord(w_param), (HWND)(l_param)) );
       OnEventCase( WM_VSCROLL,        OnVerticalScroll( SplitWord(w_param), (HWND)(l_param)) );
-      OnEventCase( WM_PAINT,          OnPaint() );
+      OnEventCase( WM_MOUSEWHEEL,     OnMouseWheel( w_param ) );
+      OnEventCase( WM_TIMER,          OnTimer( w_param ) );
+      case WM_DPICHANGED: return DpiChanged( LOWORD( w_param ), (const RECT *)(l_param) );
+      case WM_DPICHANGED_AFTERPARENT: return DpiChanged( DpiScale::ForWindow( AppWindow ), NULL );
+      OnEventCase( WM_PAINT,          ProfiledPaint() );
       OnEventCase( WM_DESTROY,        OnDestroy() );
       OnEventCase( WM_CLOSE,          OnClose() );
     }
@@ -126,6 +130,117 @@ namespace WTK
      */
     return DefWindowProc( AppWindow, message, w_param, l_param );
   }
+
+  long GenericWindow::ProfiledPaint()
+  {
+    /* Helper to invoke the OnPaint() handler; when start-up profiling
+     * is active, the first such call, (for any window), is recorded as
+     * the final phase of start-up, whereupon the profile is completed.
+     */
+    if( ! StartupProfiler::Enabled() ) return Paint();
+
+    StartupProfiler::Begin( "OnPaint" );
+    long status = Paint();
+    StartupProfiler::End( "OnPaint" );
+    StartupProfiler::Complete();
+    return status;
+  }
+
+  long GenericWindow::Paint()
+  {
+    /* Helper to invoke the OnPaint() handler, for a window which does
+     * not retain a display list; otherwise, rerecord the display list,
+     * if it has been invalidated, and replay only those commands which
+     * intersect the update region.
+     */
+    if( Display == NULL ) return OnPaint();
+
+    HRGN region = CreateRectRgn( 0, 0, 0, 0 );
+    if( (region != NULL) && (GetUpdateRgn( AppWindow, region, FALSE ) == ERROR) )
+    { DeleteObject( region ); region = NULL; }
+
+    PAINTSTRUCT ps; HDC dc = BeginPaint( AppWindow, &ps );
+    if( DisplayDirty )
+    {
+      Display->Clear(); OnRecord( Display );
+      DisplayDirty = false;
+    }
+    Display->Replay( dc, &ps.rcPaint, region );
+    EndPaint( AppWindow, &ps );
+
+    if( region != NULL ) DeleteObject( region );
+    return 0L;
+  }
+
+  UINT GenericWindow::Dpi()
+  {
+    /* Retrieve the DPI of the window's monitor, caching it on first use;
+     * it is not cached before the window is created, since the monitor on
+     * which it will be displayed cannot then be known.
+     */
+    if( AppWindow == NULL ) return DpiScale::ForWindow( NULL );
+    if( WindowDpi == 0 ) WindowDpi = DpiScale::ForWindow( AppWindow );
+    return WindowDpi;
+  }
+
+  long GenericWindow::DpiChanged( UINT dpi, const RECT *suggested )
+  {
+    /* Handle WM_DPICHANGED, (for a top-level window), or its equivalent,
+     * WM_DPICHANGED_AFTERPARENT, (for a child); the monitor DPI cache is
+     * stale, so discard it.  Nothing else is required, if the DPI has not
+     * actually changed, (as is the case for a child, when its parent moves
+     * between monitors of equal DPI).
+     */
+    DpiScale::Forget();
+    if( dpi == WindowDpi ) return 0L;
+    WindowDpi = dpi;
+
+    /* Allow the derived class to rebuild any DPI dependent resources,
+     * (e.g. ScaledFont objects), before the layout is recomputed...
+     */
+    OnDpiChanged( dpi );
+    if( Display != NULL ) InvalidateDisplay();
+
+    /* ...then adopt the suggested window rectangle; this will recompute
+     * the layout, in response to WM_SIZE, unless the physical size of the
+     * window is unchanged, in which case we must recompute it explicitly.
+     */
+    if( suggested != NULL )
+    {
+      RECT now; GetWindowRect( AppWindow, &now );
+      SetWindowPos( AppWindow, NULL, suggested->left, suggested->top,
+	  suggested->right - suggested->left, suggested->bottom - suggested->top,
+	  SWP_NOZORDER | SWP_NOACTIVATE
+	);
+      if( ((now.right - now.left) != (suggested->right - suggested->left))
+      ||  ((now.bottom - now.top) != (suggested->bottom - suggested->top))  )
+	return 0L;
+    }
+    AdjustLayout();
+    InvalidateRect( AppWindow, NULL, TRUE );
+    return 0L;
+  }
+
+  void GenericWindow::RetainDisplay( bool retain )
+  {
+    /* Elect, (or decline), to paint from a retained display list.
+     */
+    if( retain && (Display == NULL) )
+    {
+      Display = new DisplayList;
+      InvalidateDisplay();
+    }
+    else if( ! retain ) { delete Display; Display = NULL; }
+  }
+
+  void GenericWindow::InvalidateDisplay()
+  {
+    /* Mark the retained display list as stale, and request repainting of
+     * the entire window, so that it will be recorded anew.
+     */
+    DisplayDirty = true;
+    if( AppWindow != NULL ) InvalidateRect( AppWindow, NULL, TRUE );
+  }
 }
 
 /* $RCSfile$: end of file */
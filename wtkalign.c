@@ -44,13 +44,10 @@
 #include <windows.h>
 #include "wtkalign.h"
 
-void AlignWindow( HWND child, unsigned int alignment )
+static void align( HWND child, unsigned int alignment )
 {
-  /* Helper to be invoked while handling a WM_CREATE or WM_INITDIALOG
-   * message; it adjusts the position at which the window or dialogue
-   * box is created, such that it is displayed either neatly centred,
-   * or flush with specified boundaries, on the screen, or within its
-   * parent window.
+  /* Local helper, to move a window, or dialogue box, to the aligned
+   * position for its current size.
    */
   HWND parent = ((alignment & WTK_ALIGN_ONSCREEN) == 0)
     /*
@@ -83,6 +80,18 @@ void AlignWindow( HWND child, unsigned int alignment )
     GetWindowRect( child, &window );
     GetWindowRect( parent, &screen );
 
+    if( parent == GetDesktopWindow() )
+    { /* The desktop window spans only the primary monitor; when we are
+       * aligning relative to the screen, we prefer the work area of the
+       * monitor on which the window is to be displayed, (which may have
+       * different bounds, and DPI, from the primary monitor, and excludes
+       * the task bar), whenever it can be identified.
+       */
+      MONITORINFO monitor; monitor.cbSize = sizeof( monitor );
+      if( GetMonitorInfo( MonitorFromWindow( child, MONITOR_DEFAULTTONEAREST ), &monitor ) )
+	screen = monitor.rcWork;
+    }
+
     /* Adjust the left-right position, setting the left ordinate for the
      * "screen" co-ordinate group to the physical left ordinate for final
      * placement of the dialogue on-screen...
@@ -164,4 +173,28 @@ void AlignWindow( HWND child, unsigned int alignment )
   }
 }
 
+void AlignWindow( HWND child, unsigned int alignment )
+{
+  /* Helper to be invoked while handling a WM_CREATE or WM_INITDIALOG
+   * message; it adjusts the position at which the window or dialogue
+   * box is created, such that it is displayed either neatly centred,
+   * or flush with specified boundaries, on the screen, or within its
+   * parent window.
+   */
+  RECT before, after;
+  GetWindowRect( child, &before );
+  align( child, alignment );
+
+  /* When the move takes a per-monitor DPI aware window to a monitor of
+   * different DPI, its WM_DPICHANGED handler will have resized it, (to
+   * the rectangle suggested by the system, which preserves its position,
+   * but not its alignment); in this case, it must be aligned again, for
+   * its new size.
+   */
+  GetWindowRect( child, &after );
+  if( ((after.right - after.left) != (before.right - before.left))
+  ||  ((after.bottom - after.top) != (before.bottom - before.top))  )
+    align( child, alignment );
+}
+
 /* $RCSfile$: end of file */
@@ -0,0 +1,543 @@
+/*
+ * wtkatlas.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation of the IconAtlas class, which decodes
+ * icons and bitmaps on worker threads, and packs them into shared 32-bpp DIB
+ * section pages, using a skyline packing algorithm.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <string.h>
+#include <process.h>
+#include "wtklite.h"
+
+/* We create no more than this many decoding threads, by default; (the
+ * decoding is not so expensive as to warrant more).
+ */
+#define WTK_ATLAS_THREADS_MAX  2
+
+namespace WTK
+{
+  /* Each atlas entry progresses through these states.
+   */
+  enum { ATLAS_PENDING, ATLAS_READY, ATLAS_FAILED };
+
+  struct AtlasEntry
+  {
+    /* The identity of each requested image, its state, and (when ready)
+     * its location within the atlas; string names are private copies.
+     */
+    HINSTANCE module;
+    const char *name;
+    unsigned int type;
+    int state, page, x, y, width, height;
+  };
+
+  struct AtlasJob
+  {
+    /* A decoding request, as passed to, and returned by, the worker
+     * threads; on return, it carries the decoded premultiplied pixels, (or
+     * NULL, if decoding failed), with their dimensions.
+     */
+    AtlasJob *next;
+    int index, size;
+    HINSTANCE module;
+    const char *name;
+    unsigned int type;
+    uint32_t *pixels;
+    int width, height;
+  };
+
+  struct AtlasSegment
+  {
+    /* One horizontal segment of the skyline, which marks the lowest free
+     * row above each range of columns within a page.
+     */
+    int x, y, width;
+  };
+
+  struct AtlasPage
+  {
+    HBITMAP bitmap;
+    uint32_t *pixels;
+    /* There can be no more segments than columns, but the insertion of
+     * a new segment precedes the trimming of those which it overlaps, so
+     * one more must be accommodated, transiently.
+     */
+    unsigned int segments;
+    AtlasSegment skyline[WTK_ATLAS_PAGE + 1];
+  };
+
+  static inline unsigned int hash( HINSTANCE module, const char *name, unsigned int type )
+  {
+    /* Local helper to compute the initial index table slot, for any image
+     * identity; the caller must reduce it modulo the table size.
+     */
+    unsigned int value = (unsigned int)((ULONG_PTR)(module)) ^ (type * 40503U);
+    if( IS_INTRESOURCE( name ) ) return value ^ ((unsigned int)((ULONG_PTR)(name)) * 2654435761U);
+    while( *name ) value = (value * 31U) + (unsigned char)(*name++);
+    return value * 2654435761U;
+  }
+
+  static inline bool same( const char *name, const char *match )
+  {
+    /* Local helper to compare resource names, which may be either integer
+     * resource identifiers, or strings.
+     */
+    if( IS_INTRESOURCE( name ) || IS_INTRESOURCE( match ) ) return name == match;
+    return strcmp( name, match ) == 0;
+  }
+
+  static HBITMAP CreateSurface( int width, int height, uint32_t **pixels )
+  {
+    /* Local helper to create a top-down 32-bpp DIB section.
+     */
+    BITMAPINFO info; memset( &info, 0, sizeof( info ) );
+    info.bmiHeader.biSize = sizeof( BITMAPINFOHEADER );
+    info.bmiHeader.biWidth = width;
+    info.bmiHeader.biHeight = -height;
+    info.bmiHeader.biPlanes = 1;
+    info.bmiHeader.biBitCount = 32;
+    info.bmiHeader.biCompression = BI_RGB;
+    return CreateDIBSection( NULL, &info, DIB_RGB_COLORS, (void **)(pixels), NULL, 0 );
+  }
+
+  IconAtlas::IconAtlas( int size, size_t limit, unsigned int threads ):
+  IconSize( size ), MemoryLimit( limit ), Window( NULL ), Message( 0 ),
+  Entry( NULL ), EntryCount( 0 ), EntrySize( 0 ), Index( NULL ), IndexMask( 0 ),
+  PendingCount( 0 ), FailureCount( 0 ), PackedArea( 0 ), Page( NULL ), PageCount( 0 ),
+  Surface( NULL ), Original( NULL ), Selected( -1 ), Queue( NULL ), QueueTail( NULL ),
+  Completed( NULL ), Work( NULL ), Thread( NULL ), ThreadCount( 0 ), Stopping( 0 )
+  {
+    /* Start the decoding threads; if none can be started, images will be
+     * decoded synchronously, as they are requested.
+     */
+    InitializeCriticalSection( &Lock );
+    if( threads == 0 )
+    {
+      SYSTEM_INFO sys; GetSystemInfo( &sys );
+      threads = sys.dwNumberOfProcessors;
+      if( threads > WTK_ATLAS_THREADS_MAX ) threads = WTK_ATLAS_THREADS_MAX;
+    }
+    if( ((Work = CreateSemaphore( NULL, 0, MAXLONG, NULL )) != NULL)
+    &&  ((Thread = (HANDLE *)(malloc( threads * sizeof( HANDLE )))) != NULL)  )
+      while( ThreadCount < threads )
+      {
+	HANDLE worker = (HANDLE)(_beginthreadex( NULL, 0, Worker, this, 0, NULL ));
+	if( worker == NULL ) break;
+	Thread[ThreadCount++] = worker;
+      }
+  }
+
+  void IconAtlas::Attach( HWND window, unsigned int message )
+  {
+    /* Nominate the window, and message, to be notified when decoded
+     * images are available for collection.
+     */
+    Window = window; Message = message;
+  }
+
+  void IconAtlas::Rehash()
+  {
+    /* Helper to rebuild the index table, at twice the entry capacity.
+     */
+    unsigned int size = 16;
+    while( size < (EntrySize << 1) ) size <<= 1;
+    unsigned int *index = (unsigned int *)(calloc( size, sizeof( unsigned int ) ));
+    if( index == NULL ) throw( runtime_error( "Insufficient memory" ) );
+    free( Index ); Index = index; IndexMask = size - 1;
+    for( unsigned int i = 0; i < EntryCount; i++ )
+    {
+      unsigned int slot = hash( Entry[i].module, Entry[i].name, Entry[i].type );
+      while( Index[slot &= IndexMask] != 0 ) ++slot;
+      Index[slot] = i + 1;
+    }
+  }
+
+  int IconAtlas::Request( HINSTANCE module, const char *name, unsigned int type )
+  {
+    /* Look up the index of a specified image, or create a new entry for
+     * it, and submit it for decoding.
+     */
+    unsigned int slot = hash( module, name, type );
+    if( Index != NULL )
+      while( Index[slot &= IndexMask] != 0 )
+      {
+	AtlasEntry *entry = Entry + Index[slot] - 1;
+	if( (entry->module == module) && (entry->type == type) && same( entry->name, name ) )
+	  return Index[slot] - 1;
+	++slot;
+      }
+
+    if( EntryCount == EntrySize )
+    {
+      unsigned int size = EntrySize ? EntrySize << 1 : 64;
+      AtlasEntry *ref = (AtlasEntry *)(realloc( Entry, size * sizeof( AtlasEntry ) ));
+      if( ref == NULL ) throw( runtime_error( "Insufficient memory" ) );
+      Entry = ref; EntrySize = size; Rehash();
+      slot = hash( module, name, type );
+      while( Index[slot &= IndexMask] != 0 ) ++slot;
+    }
+    AtlasJob *job = (AtlasJob *)(calloc( 1, sizeof( AtlasJob ) ));
+    if( ! IS_INTRESOURCE( name ) && ((name = strdup( name )) == NULL) )
+    { free( job ); job = NULL; }
+    if( job == NULL ) throw( runtime_error( "Insufficient memory" ) );
+
+    int index = EntryCount++;
+    AtlasEntry *entry = Entry + index;
+    entry->module = module; entry->name = name; entry->type = type;
+    entry->state = ATLAS_PENDING;
+    Index[slot] = index + 1;
+
+    job->index = index; job->size = IconSize;
+    job->module = module; job->name = name; job->type = type;
+    ++PendingCount;
+    if( ThreadCount == 0 )
+    {
+      /* There are no decoding threads, so we must decode immediately.
+       */
+      job->pixels = Decode( job );
+      Store( job );
+      return index;
+    }
+    EnterCriticalSection( &Lock );
+    if( QueueTail == NULL ) Queue = job; else QueueTail->next = job;
+    QueueTail = job;
+    LeaveCriticalSection( &Lock );
+    ReleaseSemaphore( Work, 1, NULL );
+    return index;
+  }
+
+  unsigned __stdcall IconAtlas::Worker( void *owner )
+  {
+    /* Thread procedure for each decoding thread; it takes requests from
+     * the head of the queue, and returns each decoded image to the list of
+     * completed requests, notifying the owner, whenever that list was
+     * previously empty, (i.e. when it may not yet have been notified).
+     */
+    IconAtlas *atlas = (IconAtlas *)(owner);
+    while( (WaitForSingleObject( atlas->Work, INFINITE ) == WAIT_OBJECT_0) && ! atlas->Stopping )
+    {
+      EnterCriticalSection( &atlas->Lock );
+      AtlasJob *job = atlas->Queue;
+      if( (job != NULL) && ((atlas->Queue = job->next) == NULL) ) atlas->QueueTail = NULL;
+      LeaveCriticalSection( &atlas->Lock );
+      if( job == NULL ) continue;
+
+      job->pixels = Decode( job );
+      EnterCriticalSection( &atlas->Lock );
+      bool notify = ((job->next = atlas->Completed) == NULL);
+      atlas->Completed = job;
+      LeaveCriticalSection( &atlas->Lock );
+      if( notify && (atlas->Window != NULL) )
+	PostMessage( atlas->Window, atlas->Message, 0, 0 );
+    }
+    return 0;
+  }
+
+  uint32_t *IconAtlas::Decode( AtlasJob *job )
+  {
+    /* Helper, (which may be called on any thread), to load an image, and
+     * render it to premultiplied pixels.  Icons are drawn twice, over black
+     * and over white; the difference between the renderings yields alpha,
+     * and the rendering over black yields the premultiplied colour, for
+     * icons of any format.  Bitmaps are simply copied, and made opaque.
+     */
+    UINT flags = (job->module == NULL) ? LR_LOADFROMFILE : LR_DEFAULTCOLOR;
+    HANDLE image; int width, height;
+    if( job->type == WTK_PREFETCH_BITMAP )
+    {
+      BITMAP info;
+      if( (image = LoadImage( job->module, job->name, IMAGE_BITMAP, 0, 0, flags )) == NULL )
+	return NULL;
+      GetObject( image, sizeof( info ), &info );
+      width = info.bmWidth; height = info.bmHeight;
+    }
+    else if( (image = LoadImage( job->module, job->name, IMAGE_ICON, job->size, job->size, flags )) == NULL )
+      return NULL;
+    else width = height = job->size;
+
+    uint32_t *pixels = NULL, *bits;
+    HDC dc = CreateCompatibleDC( NULL );
+    HBITMAP surface = NULL;
+    if( (dc != NULL) && (width > 0) && (height > 0) && (width <= WTK_ATLAS_PAGE)
+    &&  (height <= WTK_ATLAS_PAGE) && ((surface = CreateSurface( width, height, &bits )) != NULL)
+    &&  ((pixels = (uint32_t *)(malloc( (size_t)(width) * height * sizeof( uint32_t ) ))) != NULL)  )
+    {
+      size_t count = (size_t)(width) * height;
+      HGDIOBJ original = SelectObject( dc, surface );
+      if( job->type == WTK_PREFETCH_BITMAP )
+      {
+	HDC source = CreateCompatibleDC( dc );
+	HGDIOBJ previous = SelectObject( source, image );
+	BitBlt( dc, 0, 0, width, height, source, 0, 0, SRCCOPY );
+	SelectObject( source, previous ); DeleteDC( source );
+	GdiFlush();
+	for( size_t i = 0; i < count; i++ ) pixels[i] = bits[i] | 0xFF000000UL;
+      }
+      else
+      {
+	DrawIconEx( dc, 0, 0, (HICON)(image), width, height, 0, NULL, DI_NORMAL );
+	GdiFlush(); memcpy( pixels, bits, count * sizeof( uint32_t ) );
+	memset( bits, 0xFF, count * sizeof( uint32_t ) );
+	DrawIconEx( dc, 0, 0, (HICON)(image), width, height, 0, NULL, DI_NORMAL );
+	GdiFlush();
+	for( size_t i = 0; i < count; i++ )
+	{
+	  /* Derive alpha from the green component difference; clamp the
+	   * colour components, so that none exceeds alpha.
+	   */
+	  uint32_t black = pixels[i], white = bits[i], pixel = 0;
+	  unsigned alpha = 255 - (((white >> 8) & 0xFF) - ((black >> 8) & 0xFF));
+	  if( alpha > 255 ) alpha = 0;
+	  for( int shift = 0; shift < 24; shift += 8 )
+	  {
+	    unsigned c = (black >> shift) & 0xFF;
+	    pixel |= (uint32_t)((c > alpha) ? alpha : c) << shift;
+	  }
+	  pixels[i] = pixel | ((uint32_t)(alpha) << 24);
+	}
+      }
+      SelectObject( dc, original );
+    }
+    if( surface != NULL ) DeleteObject( surface );
+    if( dc != NULL ) DeleteDC( dc );
+    if( job->type == WTK_PREFETCH_BITMAP ) DeleteObject( image );
+    else DestroyIcon( (HICON)(image) );
+
+    job->width = width; job->height = height;
+    return pixels;
+  }
+
+  unsigned int IconAtlas::Collect()
+  {
+    /* Take all completed decoding requests, in order of completion, and
+     * store their images into the atlas; returns the number collected.
+     */
+    EnterCriticalSection( &Lock );
+    AtlasJob *job = Completed, *list = NULL;
+    Completed = NULL;
+    LeaveCriticalSection( &Lock );
+
+    unsigned int count = 0;
+    while( job != NULL )
+    { AtlasJob *next = job->next; job->next = list; list = job; job = next; }
+    while( (job = list) != NULL )
+    { list = job->next; Store( job ); ++count; }
+    return count;
+  }
+
+  void IconAtlas::Store( AtlasJob *job )
+  {
+    /* Helper to copy one decoded image into the atlas, and to release
+     * the request which carried it.
+     */
+    AtlasEntry *entry = Entry + job->index;
+    entry->state = ATLAS_FAILED;
+    if( (job->pixels != NULL) && Pack( job->width, job->height, &entry->page, &entry->x, &entry->y ) )
+    {
+      uint32_t *dst = Page[entry->page].pixels + entry->y * WTK_ATLAS_PAGE + entry->x;
+      for( int row = 0; row < job->height; row++, dst += WTK_ATLAS_PAGE )
+	memcpy( dst, job->pixels + row * job->width, job->width * sizeof( uint32_t ) );
+      entry->width = job->width; entry->height = job->height;
+      entry->state = ATLAS_READY;
+      PackedArea += job->width * job->height;
+    }
+    else ++FailureCount;
+    --PendingCount;
+    free( job->pixels );
+    free( job );
+  }
+
+  static int Fit( AtlasPage *page, unsigned int i, int width, int height )
+  {
+    /* Local helper to determine the lowest position, at which an image
+     * of specified size could be placed, with its left edge at the start of
+     * a specified skyline segment; returns -1, if it does not fit there.
+     */
+    int y = 0;
+    if( (page->skyline[i].x + width) > WTK_ATLAS_PAGE ) return -1;
+    for( int remaining = width; remaining > 0; remaining -= page->skyline[i++].width )
+      if( (y < page->skyline[i].y) && ((y = page->skyline[i].y) + height) > WTK_ATLAS_PAGE )
+	return -1;
+    return (y + height > WTK_ATLAS_PAGE) ? -1 : y;
+  }
+
+  bool IconAtlas::Pack( int width, int height, int *page, int *x, int *y )
+  {
+    /* Helper to allocate space for an image; it is placed at the lowest
+     * available position, (and leftmost, among equals), within the first
+     * page in which it fits, adding a new page if necessary, and permitted
+     * by the memory limit.
+     */
+    AtlasPage *use = NULL; unsigned int best = 0; int top = 0;
+    for( unsigned int p = 0; (use == NULL) && (p <= PageCount); p++ )
+    {
+      if( p == PageCount )
+      {
+	/* No existing page has space, so add another.
+	 */
+	if( Memory() + (WTK_ATLAS_PAGE * WTK_ATLAS_PAGE * 4) > MemoryLimit ) return false;
+	AtlasPage *ref = (AtlasPage *)(realloc( Page, (PageCount + 1) * sizeof( AtlasPage ) ));
+	if( ref == NULL ) return false;
+	Page = ref; ref += PageCount;
+	if( (ref->bitmap = CreateSurface( WTK_ATLAS_PAGE, WTK_ATLAS_PAGE, &ref->pixels )) == NULL )
+	  return false;
+	ref->segments = 1;
+	ref->skyline[0].x = ref->skyline[0].y = 0;
+	ref->skyline[0].width = WTK_ATLAS_PAGE;
+	++PageCount;
+      }
+      for( unsigned int i = 0; i < Page[p].segments; i++ )
+      {
+	int position = Fit( Page + p, i, width, height );
+	if( (position >= 0) && ((use == NULL) || (position < top)) )
+	{ use = Page + p; best = i; top = position; *page = p; }
+      }
+    }
+    if( use == NULL ) return false;
+
+    /* Raise the skyline, by inserting a new segment for the top edge of
+     * the placed image, and trimming, (or removing), any which it overlaps;
+     * then merge any adjacent segments which have become level.
+     */
+    AtlasSegment *seg = use->skyline;
+    *x = seg[best].x; *y = top;
+    memmove( seg + best + 1, seg + best, (use->segments++ - best) * sizeof( AtlasSegment ) );
+    seg[best].y = top + height; seg[best].width = width;
+    for( unsigned int i = best + 1; i < use->segments; )
+    {
+      int overlap = seg[best].x + seg[best].width - seg[i].x;
+      if( overlap <= 0 ) break;
+      if( (seg[i].width -= overlap) > 0 ) { seg[i].x += overlap; break; }
+      memmove( seg + i, seg + i + 1, (--use->segments - i) * sizeof( AtlasSegment ) );
+    }
+    for( unsigned int i = 1; i < use->segments; )
+      if( seg[i].y == seg[i - 1].y )
+      {
+	seg[i - 1].width += seg[i].width;
+	memmove( seg + i, seg + i + 1, (--use->segments - i) * sizeof( AtlasSegment ) );
+      }
+      else ++i;
+    return true;
+  }
+
+  bool IconAtlas::Ready( int index )
+  {
+    /* Check whether a specified image is available to be drawn, first
+     * collecting any outstanding decoded images.
+     */
+    if( Completed != NULL ) Collect();
+    return (index >= 0) && ((unsigned int)(index) < EntryCount)
+      && (Entry[index].state == ATLAS_READY);
+  }
+
+  bool IconAtlas::Draw( HDC dc, int x, int y, int index )
+  {
+    /* Draw a specified image, with its top left corner at (x, y), by
+     * blending it from its atlas page, through the shared memory DC.
+     */
+    if( ! Ready( index ) ) return false;
+    AtlasEntry *entry = Entry + index;
+    if( (Surface == NULL) && ((Surface = CreateCompatibleDC( NULL )) == NULL) ) return false;
+    if( Selected != entry->page )
+    {
+      HGDIOBJ previous = SelectObject( Surface, Page[entry->page].bitmap );
+      if( Selected < 0 ) Original = (HBITMAP)(previous);
+      Selected = entry->page;
+    }
+    BLENDFUNCTION blend = { AC_SRC_OVER, 0, 255, AC_SRC_ALPHA };
+    return AlphaBlend( dc, x, y, entry->width, entry->height,
+	Surface, entry->x, entry->y, entry->width, entry->height, blend
+      ) != FALSE;
+  }
+
+  bool IconAtlas::Draw( Canvas *canvas, int x, int y, int index )
+  {
+    /* Draw a specified image directly onto a Canvas; this requires no
+     * GDI operation, since both are simply premultiplied pixel arrays.
+     */
+    if( ! Ready( index ) ) return false;
+    AtlasEntry *entry = Entry + index;
+    canvas->Blend( x, y, Page[entry->page].pixels + entry->y * WTK_ATLAS_PAGE + entry->x,
+	entry->width, entry->height, WTK_ATLAS_PAGE
+      );
+    return true;
+  }
+
+  double IconAtlas::Occupancy()
+  {
+    /* Compute the fraction of the allocated page area which is occupied
+     * by packed images.
+     */
+    return PageCount ? (double)(PackedArea) / ((double)(PageCount) * WTK_ATLAS_PAGE * WTK_ATLAS_PAGE) : 0.0;
+  }
+
+  IconAtlas::~IconAtlas()
+  {
+    /* Stop the decoding threads, abandoning any undecoded requests; then
+     * release all pages, requests, and entries.
+     */
+    InterlockedExchange( &Stopping, 1 );
+    if( ThreadCount > 0 )
+    {
+      ReleaseSemaphore( Work, ThreadCount, NULL );
+      WaitForMultipleObjects( ThreadCount, Thread, TRUE, INFINITE );
+      while( ThreadCount > 0 ) CloseHandle( Thread[--ThreadCount] );
+    }
+    free( Thread );
+    if( Work != NULL ) CloseHandle( Work );
+    for( AtlasJob *job = Queue, *next; job != NULL; job = next )
+    { next = job->next; free( job ); }
+    for( AtlasJob *job = Completed, *next; job != NULL; job = next )
+    { next = job->next; free( job->pixels ); free( job ); }
+    DeleteCriticalSection( &Lock );
+
+    if( Surface != NULL )
+    {
+      if( Selected >= 0 ) SelectObject( Surface, Original );
+      DeleteDC( Surface );
+    }
+    while( PageCount > 0 ) DeleteObject( Page[--PageCount].bitmap );
+    free( Page );
+    for( unsigned int i = 0; i < EntryCount; i++ )
+      if( ! IS_INTRESOURCE( Entry[i].name ) ) free( (void *)(Entry[i].name) );
+    free( Entry );
+    free( Index );
+  }
+}
+
+/* $RCSfile$: end of file */
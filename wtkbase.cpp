@@ -12,7 +12,7 @@
  * and the implementation for the Create() method of the WindowMaker class.
  *
  * Written by Keith Marshall <keithmarshall@users.sourceforge.net>
- * Copyright (C) 2012, MinGW.org Project.
+ * Copyright (C) 2012, 2026, MinGW.org Project.
  *
  * ---------------------------------------------------------------------------
  *
@@ -50,12 +50,13 @@ namespace WTK
     /* Construct a window class registration helper, and assign
      * default attributes to suit top-level windows.
      */
+    StartupPhase phase( "WindowClassMaker" );
     hInstance = instance;
     style = CS_HREDRAW | CS_VREDRAW;
     hbrBackground = (HBRUSH)(COLOR_WINDOW + 1);
     lpszMenuName = MAKEINTRESOURCE( id );
-    hCursor = LoadCursor( (HINSTANCE)(NULL), IDC_ARROW );
-    hIcon = LoadIcon( instance, lpszMenuName );
+    hCursor = ResourcePrefetcher::Cursor( (HINSTANCE)(NULL), IDC_ARROW );
+    hIcon = ResourcePrefetcher::Icon( instance, lpszMenuName );
     lpfnWndProc = WindowProcedure;
     cbClsExtra = cbWndExtra = 0;
   }
@@ -63,8 +64,12 @@ namespace WTK
   HWND WindowMaker::Create( const char *ClassName, const char *Caption )
   {
     /* Create a generic top-level application window, with attributes
-     * appropriate to a registered (named) window class.
+     * appropriate to a registered (named) window class; its default size
+     * is chosen by the system, in pixels appropriate to the DPI of the
+     * monitor on which it is placed, if the application has elected to
+     * be DPI aware.
      */
+    StartupPhase phase( "WindowMaker::Create" );
     AppWindow = CreateWindow( ClassName,
 	Caption, WS_OVERLAPPEDWINDOW | WS_CLIPSIBLINGS,
 	CW_USEDEFAULT, CW_USEDEFAULT, CW_USEDEFAULT, CW_USEDEFAULT,
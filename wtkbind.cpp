@@ -0,0 +1,277 @@
+/*
+ * wtkbind.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation of the Binding classes, which connect
+ * observable model fields to the controls which present them, and of the
+ * BindingSet class, which applies their pending updates once per frame.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <string.h>
+#include "wtklite.h"
+
+namespace WTK
+{
+  Binding::~Binding()
+  {
+    /* A binding which is destroyed is removed from its set, so that
+     * no pending update can refer to it.
+     */
+    if( Owner != NULL ) Owner->Remove( this );
+  }
+
+  void Binding::Changed()
+  {
+    /* Mark the binding dirty, so that its control will be updated on the
+     * next flush of its set, or update it immediately, if it has no set.
+     */
+    if( Owner != NULL ) Owner->Mark( this );
+    else Apply();
+  }
+
+  void Binding::Unchanged()
+  {
+    if( Owner != NULL ) ++Owner->SuppressedCount;
+  }
+
+  void Binding::Applied( bool updated )
+  {
+    if( Owner != NULL ) ++(updated ? Owner->UpdateCount : Owner->SuppressedCount);
+  }
+
+  void TextBinding::Set( const char *text )
+  {
+    /* Update the bound text; this is a change only if it differs from the
+     * current value, (or if no value has yet been presented).
+     */
+    if( text == NULL ) text = "";
+    if( (Value != NULL) && (strcmp( Value, text ) == 0) && (IsDirty() || (Shown != NULL)) )
+    { Unchanged(); return; }
+
+    size_t len = strlen( text ) + 1;
+    char *ref = (char *)(realloc( Value, len ));
+    if( ref == NULL ) throw( runtime_error( "Insufficient memory" ) );
+    memcpy( Value = ref, text, len );
+    Changed();
+  }
+
+  void TextBinding::Apply()
+  {
+    /* Present the bound text, unless it is identical to the text which was
+     * most recently presented, (e.g. when it has changed, and then changed
+     * back again, within one frame).
+     */
+    if( (Target == NULL) || ((Shown != NULL) && (strcmp( Shown, Get() ) == 0)) )
+    { Applied( false ); return; }
+
+    ChangeCaption( Target, Get() );
+    free( Shown ); Shown = strdup( Get() );
+    Applied( true );
+  }
+
+  void ValueBinding::Set( long value )
+  {
+    /* Update the bound value; this is a change only if it differs from the
+     * current value, (or if no value has yet been presented).
+     */
+    if( (value == Value) && (IsDirty() || Valid) ) { Unchanged(); return; }
+    Value = value; Changed();
+  }
+
+  void ValueBinding::Apply()
+  {
+    /* Present the bound value, by sending the setter message, unless it
+     * is identical to the value which was most recently presented.
+     */
+    if( (Target == NULL) || (Valid && (Shown == Value)) ) { Applied( false ); return; }
+
+    if( InLParam ) SendMessage( Target, Message, TRUE, (LPARAM)(Value) );
+    else SendMessage( Target, Message, (WPARAM)(Value), 0 );
+    Shown = Value; Valid = true;
+    Applied( true );
+  }
+
+  void RowBinding::Set( unsigned long first, unsigned long last )
+  {
+    /* Record a change to a range of rows, extending the range which is
+     * already pending, if any.
+     */
+    if( first > last ) { unsigned long tmp = first; first = last; last = tmp; }
+    if( IsDirty() )
+    {
+      if( first < First ) First = first;
+      if( last > Last ) Last = last;
+    }
+    else { First = first; Last = last; }
+    Changed();
+  }
+
+  void RowBinding::Apply()
+  {
+    /* Invalidate all accumulated rows, together.
+     */
+    List->Invalidate( First, Last );
+    Applied( true );
+  }
+
+  BindingSet::BindingSet( unsigned int frame ):
+  Owner( NULL ), Frame( frame ), Armed( false ), Head( NULL ), Tail( NULL ),
+  InFlight( NULL ), Member( NULL ), MemberCount( 0 ), MemberSize( 0 ), ChangeCount( 0 ),
+  CoalescedCount( 0 ), UpdateCount( 0 ), SuppressedCount( 0 ), FrameCount( 0 )
+  {
+    /* The frame clock is a synchronisation timer, (as for TimerWheel),
+     * so that each signal is consumed by the wait within the message loop;
+     * it is armed, as a one-shot timer, only when a binding becomes dirty.
+     */
+    if( (Clock = CreateWaitableTimer( NULL, FALSE, NULL )) == NULL )
+      throw( runtime_error( "Binding set initialisation FAILED" ) );
+  }
+
+  void BindingSet::Attach( MainWindowMaker *owner )
+  {
+    /* Attach the frame clock to the message loop, on which all pending
+     * updates will be applied.
+     */
+    (Owner = owner)->AttachMonitor( this );
+  }
+
+  void BindingSet::Add( Binding *binding )
+  {
+    /* Add a binding to this set, removing it from any other.
+     */
+    if( binding->Owner == this ) return;
+    if( binding->Owner != NULL ) binding->Owner->Remove( binding );
+    if( MemberCount == MemberSize )
+    {
+      unsigned int size = MemberSize ? MemberSize << 1 : 16;
+      Binding **ref = (Binding **)(realloc( Member, size * sizeof( Binding * ) ));
+      if( ref == NULL ) throw( runtime_error( "Insufficient memory" ) );
+      Member = ref; MemberSize = size;
+    }
+    Member[MemberCount++] = binding;
+    binding->Owner = this;
+  }
+
+  void BindingSet::Remove( Binding *binding )
+  {
+    /* Remove a binding from this set, discarding any pending update;
+     * this may be queued for the next frame, or for the remainder of a
+     * frame which is currently being flushed, (e.g. when the binding is
+     * removed, or destroyed, by a handler invoked by another's Apply()).
+     */
+    if( binding->Owner != this ) return;
+    for( unsigned int i = 0; i < MemberCount; i++ )
+      if( Member[i] == binding ) { Member[i] = Member[--MemberCount]; break; }
+    if( binding->Dirty )
+    {
+      if( ! Unlink( &Head, &Tail, binding ) ) Unlink( &InFlight, NULL, binding );
+      binding->Dirty = false;
+    }
+    binding->Owner = NULL; binding->Next = NULL;
+  }
+
+  bool BindingSet::Unlink( Binding **head, Binding **tail, Binding *binding )
+  {
+    /* Helper to remove a binding from a specified chain, (adjusting its
+     * tail, if tracked); returns false, if the binding is not found.
+     */
+    Binding *prev = NULL;
+    for( Binding *ref = *head; ref != NULL; prev = ref, ref = ref->Next )
+      if( ref == binding )
+      {
+	if( prev == NULL ) *head = ref->Next; else prev->Next = ref->Next;
+	if( (tail != NULL) && (*tail == ref) ) *tail = prev;
+	return true;
+      }
+    return false;
+  }
+
+  void BindingSet::Mark( Binding *binding )
+  {
+    /* Helper to queue a dirty binding, in order of first change; it is
+     * queued only once per frame, and the frame clock is started, if it is
+     * not already running.
+     */
+    ++ChangeCount;
+    if( binding->Dirty ) { ++CoalescedCount; return; }
+    binding->Dirty = true; binding->Next = NULL;
+    if( Tail == NULL ) Head = binding; else Tail->Next = binding;
+    Tail = binding;
+    if( ! Armed )
+    {
+      LARGE_INTEGER due; due.QuadPart = -10000LL * Frame;
+      Armed = SetWaitableTimer( Clock, &due, 0, NULL, NULL, FALSE ) != FALSE;
+    }
+  }
+
+  void BindingSet::Flush()
+  {
+    /* Apply the pending updates of all dirty bindings; any binding which
+     * becomes dirty again, while this is in progress, will be updated on
+     * the following frame.  The bindings remaining to be updated are held
+     * in a member chain, (rather than a local one), and each is taken from
+     * it only as it is applied, so that Remove() may unlink any which an
+     * earlier Apply() causes to be removed, or destroyed.
+     */
+    InFlight = Head; Head = Tail = NULL;
+    if( Armed ) { CancelWaitableTimer( Clock ); Armed = false; }
+    if( InFlight != NULL ) ++FrameCount;
+    Binding *binding;
+    while( (binding = InFlight) != NULL )
+    {
+      InFlight = binding->Next;
+      binding->Next = NULL; binding->Dirty = false;
+      binding->Apply();
+    }
+  }
+
+  BindingSet::~BindingSet()
+  {
+    /* Detach from the message loop, and release all bindings, discarding
+     * any pending updates.
+     */
+    if( Owner != NULL ) Owner->DetachMonitor( this );
+    while( MemberCount > 0 )
+    {
+      Binding *binding = Member[--MemberCount];
+      binding->Owner = NULL; binding->Next = NULL; binding->Dirty = false;
+    }
+    free( Member );
+    CloseHandle( Clock );
+  }
+}
+
+/* $RCSfile$: end of file */
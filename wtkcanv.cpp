@@ -0,0 +1,263 @@
+/*
+ * wtkcanv.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation of the Canvas class, an off-screen
+ * 32-bpp DIB section drawing surface, which is rendered by the pixel kernels
+ * of wtkpixel.c, and presented to a window by a single BitBlt() operation.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <math.h>
+#include <string.h>
+#include "wtklite.h"
+
+namespace WTK
+{
+  static inline uint32_t Premultiplied( COLORREF colour, BYTE alpha )
+  {
+    /* Helper to convert a COLORREF, with straight alpha, to a pixel value.
+     */
+    return wtk_pixel_premultiply( GetRValue( colour ), GetGValue( colour ), GetBValue( colour ), alpha );
+  }
+
+  Canvas::Canvas(): Surface( NULL ), Bitmap( NULL ), Original( NULL ),
+  Pixels( NULL ), Coverage( NULL ), CanvasWidth( 0 ), CanvasHeight( 0 ){}
+
+  void Canvas::Resize( int width, int height )
+  {
+    /* Establish the DIB section, at a specified size; any existing content
+     * is discarded, and the new surface is initially transparent black.
+     */
+    if( (width == CanvasWidth) && (height == CanvasHeight) ) return;
+    if( Bitmap != NULL )
+    {
+      SelectObject( Surface, Original );
+      DeleteObject( Bitmap );
+      Bitmap = NULL; Pixels = NULL;
+    }
+    CanvasWidth = CanvasHeight = 0;
+    if( (width <= 0) || (height <= 0) ) return;
+
+    if( (Surface == NULL) && ((Surface = CreateCompatibleDC( NULL )) == NULL) )
+      throw( runtime_error( "Cannot create canvas device context" ) );
+
+    BITMAPINFO info; memset( &info, 0, sizeof( info ) );
+    info.bmiHeader.biSize = sizeof( BITMAPINFOHEADER );
+    info.bmiHeader.biWidth = width;
+    info.bmiHeader.biHeight = -height;
+    info.bmiHeader.biPlanes = 1;
+    info.bmiHeader.biBitCount = 32;
+    info.bmiHeader.biCompression = BI_RGB;
+
+    void *bits;
+    if( (Bitmap = CreateDIBSection( Surface, &info, DIB_RGB_COLORS, &bits, NULL, 0 )) == NULL )
+      throw( runtime_error( "Cannot create canvas DIB section" ) );
+
+    uint8_t *ref = (uint8_t *)(realloc( Coverage, width ));
+    if( ref == NULL )
+    { DeleteObject( Bitmap ); Bitmap = NULL;
+      throw( runtime_error( "Insufficient memory" ) );
+    }
+    Original = (HBITMAP)(SelectObject( Surface, Bitmap ));
+    Pixels = (uint32_t *)(bits); Coverage = ref;
+    CanvasWidth = width; CanvasHeight = height;
+  }
+
+  bool Canvas::Clip( const RECT *rect, RECT *clip )
+  {
+    /* Helper to clip a drawing rectangle to the canvas bounds, returning
+     * false if nothing remains to be drawn; it also ensures that any GDI
+     * operations, on the canvas device context, have been completed before
+     * the pixels are modified directly.
+     */
+    clip->left = (rect->left < 0) ? 0 : rect->left;
+    clip->top = (rect->top < 0) ? 0 : rect->top;
+    clip->right = (rect->right > CanvasWidth) ? CanvasWidth : rect->right;
+    clip->bottom = (rect->bottom > CanvasHeight) ? CanvasHeight : rect->bottom;
+    if( (clip->left >= clip->right) || (clip->top >= clip->bottom) ) return false;
+    GdiFlush(); return true;
+  }
+
+  void Canvas::Fill( const RECT *rect, COLORREF colour, BYTE alpha )
+  {
+    /* Fill a rectangle with a solid colour; when opaque, it simply replaces
+     * existing content, otherwise it is blended over that content.
+     */
+    RECT clip;
+    if( Clip( rect, &clip ) )
+    {
+      uint32_t pixel = Premultiplied( colour, alpha );
+      size_t count = clip.right - clip.left;
+      for( int y = clip.top; y < clip.bottom; y++ )
+      {
+	if( alpha == 255 ) wtk_pixel_fill( Row( y ) + clip.left, count, pixel );
+	else if( alpha != 0 ) wtk_pixel_blend_solid( Row( y ) + clip.left, count, pixel );
+      }
+    }
+  }
+
+  void Canvas::Gradient( const RECT *rect, COLORREF from, COLORREF to, bool vertical )
+  {
+    /* Fill a rectangle with an opaque linear gradient, running from left
+     * to right, or from top to bottom, with the specified end colours at
+     * the outermost pixels of the unclipped rectangle.
+     */
+    RECT clip;
+    if( Clip( rect, &clip ) )
+    {
+      uint32_t a = Premultiplied( from, 255 ), b = Premultiplied( to, 255 );
+      int span = vertical ? rect->bottom - rect->top : rect->right - rect->left;
+      /* The step is rounded up, so that the outermost pixel reaches the
+       * end colour; the kernel clamps any overshoot of the position.
+       */
+      int32_t step = (span > 1) ? (0x10000 + span - 2) / (span - 1) : 0;
+      size_t count = clip.right - clip.left;
+      if( vertical )
+      {
+	/* Each row is a single colour, computed by the gradient kernel,
+	 * and then replicated by the fill kernel.
+	 */
+	for( int y = clip.top; y < clip.bottom; y++ )
+	{
+	  uint32_t pixel;
+	  wtk_pixel_gradient( &pixel, 1, a, b, (y - rect->top) * step, 0 );
+	  wtk_pixel_fill( Row( y ) + clip.left, count, pixel );
+	}
+      }
+      else
+      {
+	/* Every row is identical, so compute only the first, and copy it.
+	 */
+	uint32_t *first = Row( clip.top ) + clip.left;
+	wtk_pixel_gradient( first, count, a, b, (clip.left - rect->left) * step, step );
+	for( int y = clip.top + 1; y < clip.bottom; y++ )
+	  memcpy( Row( y ) + clip.left, first, count * sizeof( uint32_t ) );
+      }
+    }
+  }
+
+  void Canvas::RoundRect
+  ( const RECT *rect, int radius, COLORREF colour, BYTE alpha )
+  {
+    /* Fill a rectangle, with anti-aliased rounded corners of specified
+     * radius, blending it over existing content.  Rows which intersect the
+     * corners are drawn through a coverage mask; the coverage of each corner
+     * pixel is derived from the distance of its centre from the centre of
+     * the corner arc.  All other rows are filled as a solid span.
+     */
+    RECT clip;
+    if( ! Clip( rect, &clip ) || (alpha == 0) ) return;
+
+    int width = rect->right - rect->left, height = rect->bottom - rect->top;
+    if( radius > (width >> 1) ) radius = width >> 1;
+    if( radius > (height >> 1) ) radius = height >> 1;
+    if( radius < 0 ) radius = 0;
+
+    uint32_t pixel = Premultiplied( colour, alpha );
+    size_t count = clip.right - clip.left;
+    for( int y = clip.top; y < clip.bottom; y++ )
+    {
+      /* Identify the vertical distance, if any, from the centre of this
+       * row to the centres of the corner arcs.
+       */
+      double dy = 0.0;
+      if( (y - rect->top) < radius ) dy = rect->top + radius - (y + 0.5);
+      else if( (rect->bottom - y) <= radius ) dy = (y + 0.5) - (rect->bottom - radius);
+      if( dy <= 0.0 )
+      {
+	if( alpha == 255 ) wtk_pixel_fill( Row( y ) + clip.left, count, pixel );
+	else wtk_pixel_blend_solid( Row( y ) + clip.left, count, pixel );
+	continue;
+      }
+      uint8_t *mask = Coverage; memset( mask, 255, count );
+      for( int x = 0; x < radius; x++ )
+      {
+	/* Compute the coverage for one column of each corner; (the two
+	 * corners are symmetrical), and record it for each column which
+	 * lies within the clipping rectangle.
+	 */
+	double dx = radius - (x + 0.5), d = radius + 0.5 - sqrt( dx * dx + dy * dy );
+	uint8_t value = (d <= 0.0) ? 0 : (d >= 1.0) ? 255 : (uint8_t)(d * 255.0 + 0.5);
+	int left = rect->left + x, right = rect->right - 1 - x;
+	if( (left >= clip.left) && (left < clip.right) ) mask[left - clip.left] = value;
+	if( (right >= clip.left) && (right < clip.right) ) mask[right - clip.left] = value;
+      }
+      wtk_pixel_blend_mask( Row( y ) + clip.left, mask, count, pixel );
+    }
+  }
+
+  void Canvas::Blend
+  ( int x, int y, const uint32_t *src, int width, int height, int stride )
+  {
+    /* Composite a block of premultiplied source pixels, (with rows of
+     * "stride" pixels), over the canvas, with its origin at (x, y).
+     */
+    RECT rect = { x, y, x + width, y + height }, clip;
+    if( Clip( &rect, &clip ) )
+    {
+      src += (size_t)(clip.top - y) * stride + (clip.left - x);
+      for( int row = clip.top; row < clip.bottom; row++, src += stride )
+	wtk_pixel_blend( Row( row ) + clip.left, src, clip.right - clip.left );
+    }
+  }
+
+  void Canvas::Present( HDC dc, const RECT *update, int x, int y )
+  {
+    /* Copy the canvas, or only that part of it which corresponds to the
+     * specified update rectangle, (e.g. the rcPaint member of the caller's
+     * PAINTSTRUCT), to a device context, at an origin of (x, y) within it.
+     */
+    RECT rect = { x, y, x + CanvasWidth, y + CanvasHeight };
+    if( (Bitmap != NULL) && ((update == NULL) || IntersectRect( &rect, &rect, update )) )
+    {
+      GdiFlush();
+      BitBlt( dc, rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top,
+	  Surface, rect.left - x, rect.top - y, SRCCOPY
+	);
+    }
+  }
+
+  Canvas::~Canvas()
+  {
+    /* Release the DIB section, its device context, and the coverage mask.
+     */
+    if( Bitmap != NULL ) { SelectObject( Surface, Original ); DeleteObject( Bitmap ); }
+    if( Surface != NULL ) DeleteDC( Surface );
+    free( Coverage );
+  }
+}
+
+/* $RCSfile$: end of file */
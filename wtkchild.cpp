@@ -9,10 +9,11 @@
  * $Id$
  *
  * This file provides the implementation for the Create() method of
- * the ChildWindowMaker class.
+ * the ChildWindowMaker class, together with the complementary methods
+ * which support deferred creation of child windows.
  *
  * Written by Keith Marshall <keithmarshall@users.sourceforge.net>
- * Copyright (C) 2012, MinGW.org Project.
+ * Copyright (C) 2012, 2026, MinGW.org Project.
  *
  * ---------------------------------------------------------------------------
  *
@@ -51,8 +52,10 @@ namespace WTK
     /* Create a generic child window, with specified ID, and
      * owned by specified parent.
      */
+    StartupPhase phase( "ChildWindowMaker::Create" );
     HWND child_window = CreateWindow( ClassName,
-	NULL, style | WS_CHILD | WS_CLIPSIBLINGS, 0, 0, 0, 0,
+	NULL, style | WS_CHILD | WS_CLIPSIBLINGS, Frame.left, Frame.top,
+	Frame.right - Frame.left, Frame.bottom - Frame.top,
 	Parent, (HMENU)(id), AppInstance, this
       );
     if( ! child_window )
@@ -64,9 +67,71 @@ namespace WTK
       snprintf( description, sizeof( description ), fmt, ClassName );
       throw( runtime_error( description ) );
     }
-    /* On success, return the window handle.
+    /* On success, return the window handle; (for a window class which
+     * doesn't use our own window procedure, this is the first point at
+     * which we may record it).
      */
-    return child_window;
+    return AppWindow = child_window;
+  }
+
+  void ChildWindowMaker::Defer
+  ( int id, HWND Parent, const char *ClassName, unsigned long style )
+  {
+    /* Record the attributes which would otherwise have been passed
+     * to Create(), so that creation of the window may be deferred
+     * until it is actually required.
+     */
+    DeferredID = id;
+    DeferredParent = Parent;
+    DeferredClassName = ClassName;
+    DeferredStyle = style;
+  }
+
+  HWND ChildWindowMaker::Realise( void )
+  {
+    /* Ensure that a deferred window has been created, (creating it
+     * now if necessary), and return its handle; this is a no-op for
+     * a window which has already been created, and returns NULL if
+     * there is neither an extant window, nor a deferred request.
+     */
+    if( (AppWindow == NULL) && (DeferredClassName != NULL) )
+    {
+      /* There is a pending deferred creation request; satisfy it,
+       * at the most recently recorded placement, (by way of the derived
+       * class's own creation method), then discard it, (but only if it
+       * has been satisfied; if creation fails, it remains pending).
+       */
+      OnRealise( DeferredID, DeferredParent, DeferredClassName, DeferredStyle );
+      DeferredClassName = NULL;
+    }
+    return AppWindow;
+  }
+
+  int ChildWindowMaker::Place( int x, int y, int width, int height )
+  {
+    /* Helper for use by layout code; when the window has already been
+     * realised, it is simply moved, and resized, as specified...
+     */
+    if( AppWindow != NULL )
+      return MoveWindow( AppWindow, x, y, width, height, TRUE );
+
+    /* ...otherwise, it remains as a placeholder, and we record only
+     * the placement which is to be applied when it is realised.
+     */
+    Frame.left = x; Frame.right = x + width;
+    Frame.top = y; Frame.bottom = y + height;
+    return (int)(true);
+  }
+
+  int ChildWindowMaker::Show( int mode )
+  {
+    /* Display the window, as for WindowMaker::Show(), but realising
+     * it first, if it had been deferred; there is no need to realise
+     * a deferred window, merely to hide it.
+     */
+    if( (mode == SW_HIDE) && (AppWindow == NULL) )
+      return (int)(false);
+    return (Realise() != NULL) ? WindowMaker::Show( mode ) : (int)(false);
   }
 }
 
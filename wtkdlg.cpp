@@ -0,0 +1,261 @@
+/*
+ * wtkdlg.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation for the dialogue template cache,
+ * which is used by both GenericDialogue and ModelessDialogue objects, and
+ * for the methods of the ModelessDialogue class.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include "wtklite.h"
+#include "wtkalign.h"
+
+namespace WTK
+{
+  struct DialogueTemplateCacheEntry
+  {
+    /* Each cache entry associates a dialogue template with the module
+     * and resource ID by which it is identified.
+     */
+    HINSTANCE module;
+    int id;
+    LPCDLGTEMPLATE dlg;
+  };
+
+  static DialogueTemplateCacheEntry *template_cache = NULL;
+  static unsigned int template_count = 0, template_limit = 0;
+  static volatile LONG template_lock = 0;
+
+  static DialogueTemplateCacheEntry *cached_template( HINSTANCE module, int id )
+  {
+    /* Local helper, to locate the cache entry, if any, for a specified
+     * dialogue template; the cache is expected to be small, so a simple
+     * linear search is adequate.
+     */
+    for( unsigned int i = 0; i < template_count; i++ )
+      if( (template_cache[i].id == id) && (template_cache[i].module == module) )
+	return template_cache + i;
+    return NULL;
+  }
+
+  static void cache_template( HINSTANCE module, int id, LPCDLGTEMPLATE dlg )
+  {
+    /* Local helper, to add a dialogue template to the cache, (or replace
+     * an existing entry); the caller must hold the template_lock.
+     */
+    DialogueTemplateCacheEntry *entry = cached_template( module, id );
+    if( entry == NULL )
+    {
+      if( template_count >= template_limit )
+      {
+	/* The cache is full; it must be expanded.
+	 */
+	unsigned int limit = template_limit ? template_limit << 1 : 16;
+	void *tmp = realloc( template_cache, limit * sizeof( DialogueTemplateCacheEntry ));
+	if( tmp == NULL ) throw( runtime_error( "Insufficient memory" ) );
+	template_cache = (DialogueTemplateCacheEntry *)(tmp); template_limit = limit;
+      }
+      entry = template_cache + template_count++;
+      entry->module = module; entry->id = id;
+    }
+    entry->dlg = dlg;
+  }
+
+  void GenericDialogue::RegisterTemplate
+  ( HINSTANCE module, int id, LPCDLGTEMPLATE dlg )
+  {
+    /* Add a dialogue template to the cache, (or replace an existing
+     * entry); the template itself is not copied, so it must remain
+     * valid for as long as it may be used.
+     */
+    SpinLock hold( &template_lock );
+    cache_template( module, id, dlg );
+  }
+
+  LPCDLGTEMPLATE GenericDialogue::Template( HINSTANCE module, int id )
+  {
+    /* Retrieve a dialogue template from the cache, or on first use,
+     * from the module's resources; a resource template remains locked
+     * in memory for the lifetime of the module, so it may be cached by
+     * reference.  Returns NULL, if no such template can be found.
+     */
+    SpinLock hold( &template_lock );
+    DialogueTemplateCacheEntry *entry = cached_template( module, id );
+    if( entry != NULL ) return entry->dlg;
+
+    HRSRC resource; HGLOBAL handle; LPCDLGTEMPLATE dlg = NULL;
+    if( ((resource = FindResource( module, MAKEINTRESOURCE( id ), RT_DIALOG )) != NULL)
+    &&  ((handle = LoadResource( module, resource )) != NULL)  )
+      if( (dlg = (LPCDLGTEMPLATE)(LockResource( handle ))) != NULL )
+	cache_template( module, id, dlg );
+    return dlg;
+  }
+
+  __thread ModelessDialogue *ModelessDialogue::OpenDialogues = NULL;
+
+  HWND ModelessDialogue::Create( HWND parent, int id )
+  {
+    /* Open the dialogue, from the specified template, unless it is
+     * already open, in which case we simply activate it.
+     */
+    if( AppDialogue == NULL )
+    {
+      LPCDLGTEMPLATE dlg = GenericDialogue::Template( AppInstance, id );
+      if( (dlg == NULL) || (CreateDialogIndirectParam( AppInstance, dlg,
+	    parent, DialogueProcedure, (LPARAM)(this) ) == NULL)  )
+	throw( runtime_error( error_text( "Dialogue #%d: creation FAILED", id )) );
+    }
+    ShowWindow( AppDialogue, SW_SHOW );
+    SetForegroundWindow( AppDialogue );
+    return AppDialogue;
+  }
+
+  bool ModelessDialogue::Dispatch( MSG *message )
+  {
+    /* Offer a message to each open modeless dialogue in turn, until
+     * one of them accepts it.
+     */
+    for( ModelessDialogue *ref = OpenDialogues; ref != NULL; ref = ref->Next )
+      if( IsDialogMessage( ref->AppDialogue, message ) ) return true;
+    return false;
+  }
+
+  BOOL CALLBACK ModelessDialogue::DialogueProcedure
+  ( HWND dlg, unsigned message, WPARAM w_param, LPARAM l_param )
+  {
+    /* Generic dispatcher for all modeless dialogue procedures; much as
+     * for GenericWindow::WindowProcedure(), it must establish a pointer
+     * to the class instance, before delegating to its Controller().
+     */
+    ModelessDialogue *me;
+    if( message == WM_INITDIALOG )
+    {
+      /* The class instance pointer is passed as the initialisation
+       * parameter; save it, and link the dialogue into the list of
+       * those which are now open.
+       */
+      me = (ModelessDialogue *)(l_param);
+      SetWindowLongPtr( dlg, DWLP_USER, (LONG_PTR)(me) );
+      me->AppDialogue = dlg;
+      me->Next = OpenDialogues; OpenDialogues = me;
+    }
+    else if( (me = (ModelessDialogue *)(GetWindowLongPtr( dlg, DWLP_USER ))) == NULL )
+      return FALSE;
+
+    if( message == WM_NCDESTROY )
+    {
+      /* This is the last message which the dialogue will receive;
+       * unlink it from the list of open dialogues, and dissociate it
+       * from the class instance, so that it may be reopened.
+       */
+      me->Detach();
+      me->OnDestroy();
+      return FALSE;
+    }
+    return me->Controller( message, w_param, l_param );
+  }
+
+  void ModelessDialogue::Detach()
+  {
+    /* Helper to unlink the dialogue from the list of those which are
+     * open, and dissociate it from the class instance, so that it may be
+     * reopened, and so that it will deliver no further messages.
+     */
+    ModelessDialogue **ref = &OpenDialogues;
+    while( (*ref != NULL) && (*ref != this) ) ref = &((*ref)->Next);
+    if( *ref != NULL ) *ref = Next;
+    SetWindowLongPtr( AppDialogue, DWLP_USER, 0 );
+    AppDialogue = NULL;
+  }
+
+  void ModelessDialogue::Destroy( bool detach )
+  {
+    /* Helper, common to Close() and the destructor, to destroy the
+     * dialogue, if it is open; from the destructor, it is first detached,
+     * so that none of its final messages are delivered to the partially
+     * destroyed object.
+     */
+    HWND dlg = AppDialogue;
+    if( dlg != NULL )
+    {
+      if( detach ) Detach();
+      DestroyWindow( dlg );
+    }
+  }
+
+  BOOL ModelessDialogue::Controller
+  ( unsigned message, WPARAM w_param, LPARAM l_param )
+  {
+    /* Default marshalling function for modeless dialogue messages;
+     * in common with GenericDialogue::Dismiss(), we handle only the
+     * initialisation and command messages.
+     */
+    switch( message )
+    {
+      case WM_INITDIALOG:
+	return OnInitDialogue();
+
+      case WM_COMMAND:
+	return OnCommand( w_param );
+    }
+    return FALSE;
+  }
+
+  BOOL ModelessDialogue::OnInitDialogue()
+  {
+    /* By default, we centre the dialogue over its parent window.
+     */
+    AlignWindow( AppDialogue, WTK_ALIGN_CENTRED );
+    return TRUE;
+  }
+
+  BOOL ModelessDialogue::OnCommand( WPARAM w_param )
+  {
+    /* By default, we respond only to IDOK and IDCANCEL, either of
+     * which will close the dialogue.
+     */
+    switch( LOWORD( w_param ) )
+    {
+      case IDOK:
+      case IDCANCEL:
+	Close();
+	return TRUE;
+    }
+    return FALSE;
+  }
+}
+
+/* $RCSfile$: end of file */
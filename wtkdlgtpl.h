@@ -0,0 +1,158 @@
+#ifndef WTKDLGTPL_H
+/*
+ * wtkdlgtpl.h
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This header file declares the DialogueTemplate class, which assembles
+ * in-memory dialogue templates.  It is included by wtklite.h; it may also
+ * be included alone, by a program which is compiled for some host other
+ * than MS-Windows, (e.g. to check template layout on the build host), in
+ * which case it defines those few API types, and style constants, which it
+ * requires.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WTKDLGTPL_H  1
+
+#include <stdlib.h>
+#include "wtkexcept.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+/* For any other host, we require only the fixed width types in which a
+ * template is expressed, and the values of the default styles, (which are
+ * the values defined by the MS-Windows API itself).
+ */
+#include <stdint.h>
+typedef uint32_t DWORD;
+typedef uint16_t WCHAR;
+
+#define WS_POPUP	0x80000000UL
+#define WS_CHILD	0x40000000UL
+#define WS_VISIBLE	0x10000000UL
+#define WS_CAPTION	0x00C00000UL
+#define WS_BORDER	0x00800000UL
+#define WS_SYSMENU	0x00080000UL
+#define WS_TABSTOP	0x00010000UL
+#define DS_SETFONT	0x00000040UL
+#define DS_MODALFRAME	0x00000080UL
+#define BS_PUSHBUTTON	0x00000000UL
+#define SS_LEFT 	0x00000000UL
+#define ES_LEFT 	0x00000000UL
+#define ES_AUTOHSCROLL	0x00000080UL
+#endif
+
+namespace WTK
+{
+  /* Predefined window class atoms, which may be used to identify the
+   * class of a control within a DialogueTemplate.
+   */
+# define WTK_DIALOGUE_BUTTON	0x0080
+# define WTK_DIALOGUE_EDIT	0x0081
+# define WTK_DIALOGUE_STATIC	0x0082
+# define WTK_DIALOGUE_LISTBOX	0x0083
+# define WTK_DIALOGUE_SCROLLBAR	0x0084
+# define WTK_DIALOGUE_COMBOBOX	0x0085
+
+  class DialogueTemplate
+  {
+    /* A utility class to assemble an in-memory dialogue template, (an
+     * appropriately aligned DLGTEMPLATE, followed by its DLGITEMTEMPLATE
+     * entries), without recourse to any resource script; the result may
+     * be passed directly to DialogBoxIndirectParam(), etc., or registered
+     * in the GenericDialogue template cache, so that it is assembled only
+     * once, and is then used exactly as if it were a resource template.
+     *
+     * All strings are interpreted in the process (ANSI) code page, as
+     * elsewhere throughout the library, when converting them to the
+     * required UTF-16 form; (on any other host, only ASCII strings are
+     * accepted).  Dimensions are in dialogue units.
+     */
+    public:
+      DialogueTemplate( const char *, short, short, short, short,
+	  unsigned long = WS_POPUP | WS_CAPTION | WS_SYSMENU | DS_MODALFRAME,
+	  const char * = "MS Shell Dlg", unsigned short = 8
+	);
+      ~DialogueTemplate(){ free( (void *)(Buffer) ); }
+
+      DialogueTemplate &Control( unsigned short, int, const char *,
+	  unsigned long, short, short, short, short
+	);
+      DialogueTemplate &Control( const char *, int, const char *,
+	  unsigned long, short, short, short, short
+	);
+      DialogueTemplate &Button( int id, const char *text,
+	  short x, short y, short cx, short cy, unsigned long style = BS_PUSHBUTTON
+	){ return Control( WTK_DIALOGUE_BUTTON, id, text, style | WS_TABSTOP, x, y, cx, cy ); }
+      DialogueTemplate &Label( int id, const char *text,
+	  short x, short y, short cx, short cy, unsigned long style = SS_LEFT
+	){ return Control( WTK_DIALOGUE_STATIC, id, text, style, x, y, cx, cy ); }
+      DialogueTemplate &Edit( int id, const char *text,
+	  short x, short y, short cx, short cy, unsigned long style = ES_LEFT | ES_AUTOHSCROLL
+	){ return Control( WTK_DIALOGUE_EDIT, id, text, style | WS_BORDER | WS_TABSTOP,
+	    x, y, cx, cy ); }
+
+      const void *Data() const { return Buffer; }
+      size_t Size() const { return Length; }
+
+#     ifdef _WIN32
+      operator LPCDLGTEMPLATE() const { return (LPCDLGTEMPLATE)(Buffer); }
+
+      /* Add the assembled template to the GenericDialogue template
+       * cache; it is NOT copied, so the DialogueTemplate object must
+       * not be destroyed while the template may be used.
+       */
+      void Register( HINSTANCE, int );
+#     endif
+
+    private:
+      unsigned char *Buffer;
+      size_t Length, Limit;
+
+      /* The buffer is owned by the object, so copying is prohibited;
+       * (these are declared, but never implemented).
+       */
+      DialogueTemplate( const DialogueTemplate & );
+      DialogueTemplate &operator=( const DialogueTemplate & );
+
+      void *Append( const void *, size_t );
+      void AppendWord( unsigned short value ){ Append( &value, sizeof( value ) ); }
+      void AppendLong( DWORD value ){ Append( &value, sizeof( value ) ); }
+      void AppendText( const char * );
+      void AppendItem( unsigned long, int, short, short, short, short );
+      void CompleteItem( const char * );
+  };
+}
+
+#endif /* WTKDLGTPL_H: $RCSfile$: end of file */
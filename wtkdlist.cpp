@@ -0,0 +1,233 @@
+/*
+ * wtkdlist.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation for the DisplayList class, which
+ * records drawing commands, with their bounding rectangles, so that partial
+ * repaints may replay only those commands which intersect the damage.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <string.h>
+#include "wtklite.h"
+
+namespace WTK
+{
+  enum { WTK_DL_FILL, WTK_DL_FRAME, WTK_DL_LINE, WTK_DL_TEXT };
+
+  struct DisplayCommand
+  {
+    /* The common header for every recorded command; its size includes
+     * the command specific data which follows, and any padding required
+     * to align the next command.
+     */
+    unsigned int kind, size;
+    RECT bounds;
+    COLORREF colour;
+  };
+
+  struct DisplayStroke: DisplayCommand
+  {
+    /* Frames and lines record a pen width, and lines record their end
+     * points; (the bounds of a frame are the frame rectangle itself).
+     */
+    int width;
+    POINT from, to;
+  };
+
+  struct DisplayText: DisplayCommand
+  {
+    /* Text records its font, and the text itself, which follows as an
+     * unterminated string of specified length.
+     */
+    HFONT font;
+    int length;
+  };
+
+  DisplayList::DisplayList():
+  Buffer( NULL ), Used( 0 ), Size( 0 ), CommandCount( 0 ), Measure( NULL ){}
+
+  void DisplayList::Clear()
+  {
+    /* Discard all recorded commands, retaining the buffer for reuse.
+     */
+    Used = 0; CommandCount = 0;
+  }
+
+  void *DisplayList::Append( int kind, size_t size, const RECT *bounds )
+  {
+    /* Helper to reserve buffer space for one command, of specified kind
+     * and size, and to fill in its common header.
+     */
+    size = (size + sizeof( void * ) - 1) & ~(sizeof( void * ) - 1);
+    if( (Used + size) > Size )
+    {
+      size_t want = Size ? Size << 1 : 4096;
+      while( want < (Used + size) ) want <<= 1;
+      char *ref = (char *)(realloc( Buffer, want ));
+      if( ref == NULL ) throw( runtime_error( "Insufficient memory" ) );
+      Buffer = ref; Size = want;
+    }
+    DisplayCommand *command = (DisplayCommand *)(Buffer + Used);
+    command->kind = kind; command->size = size; command->bounds = *bounds;
+    Used += size; ++CommandCount;
+    return command;
+  }
+
+  void DisplayList::Fill( const RECT *rect, COLORREF colour )
+  {
+    /* Record a solid filled rectangle.
+     */
+    ((DisplayCommand *)(Append( WTK_DL_FILL, sizeof( DisplayCommand ), rect )))->colour = colour;
+  }
+
+  void DisplayList::Frame( const RECT *rect, COLORREF colour, int width )
+  {
+    /* Record a rectangular outline, drawn within the specified rectangle.
+     */
+    DisplayStroke *command = (DisplayStroke *)(Append( WTK_DL_FRAME, sizeof( DisplayStroke ), rect ));
+    command->colour = colour; command->width = width;
+  }
+
+  void DisplayList::Line( int x1, int y1, int x2, int y2, COLORREF colour, int width )
+  {
+    /* Record a straight line; its bounds must encompass the width of the
+     * pen, on either side of the line.
+     */
+    RECT bounds;
+    bounds.left = ((x1 < x2) ? x1 : x2) - width; bounds.right = ((x1 < x2) ? x2 : x1) + width + 1;
+    bounds.top = ((y1 < y2) ? y1 : y2) - width; bounds.bottom = ((y1 < y2) ? y2 : y1) + width + 1;
+    DisplayStroke *command = (DisplayStroke *)(Append( WTK_DL_LINE, sizeof( DisplayStroke ), &bounds ));
+    command->colour = colour; command->width = width;
+    command->from.x = x1; command->from.y = y1;
+    command->to.x = x2; command->to.y = y2;
+  }
+
+  void DisplayList::Text
+  ( int x, int y, const char *text, COLORREF colour, HFONT font, int len )
+  {
+    /* Record a text string; its bounds are measured, (through the text
+     * cache), using a private memory device context.
+     */
+    if( len < 0 ) len = strlen( text );
+    if( (Measure == NULL) && ((Measure = CreateCompatibleDC( NULL )) == NULL) )
+      throw( runtime_error( "Cannot create text measurement context" ) );
+
+    HGDIOBJ original = SelectObject( Measure, font );
+    SIZE extent = TextCache::Extent( Measure, text, len );
+    SelectObject( Measure, original );
+
+    RECT bounds = { x, y, x + extent.cx, y + extent.cy };
+    DisplayText *command = (DisplayText *)(Append( WTK_DL_TEXT, sizeof( DisplayText ) + len, &bounds ));
+    command->colour = colour; command->font = font; command->length = len;
+    memcpy( (void *)(command + 1), text, len );
+  }
+
+  void DisplayList::Replay( HDC dc, const RECT *clip, HRGN region )
+  {
+    /* Replay those recorded commands whose bounds intersect a specified
+     * clipping rectangle, (and, if specified, the update region), in the
+     * order in which they were recorded.
+     */
+    HGDIOBJ font = GetCurrentObject( dc, OBJ_FONT );
+    int mode = SetBkMode( dc, TRANSPARENT );
+    for( size_t offset = 0; offset < Used; )
+    {
+      RECT overlap;
+      DisplayCommand *command = (DisplayCommand *)(Buffer + offset);
+      offset += command->size;
+      if( ! IntersectRect( &overlap, &(command->bounds), clip )
+      ||  ((region != NULL) && ! RectInRegion( region, &(command->bounds) ))  )
+	continue;
+
+      switch( command->kind )
+      {
+	case WTK_DL_FILL:
+	  { HBRUSH brush = GdiCache::Brush( command->colour );
+	    FillRect( dc, &(command->bounds), brush );
+	    GdiCache::Release( brush );
+	  }
+	  break;
+
+	case WTK_DL_FRAME:
+	case WTK_DL_LINE:
+	  { DisplayStroke *stroke = (DisplayStroke *)(command);
+	    HPEN pen = GdiCache::Pen( stroke->colour, stroke->width,
+		(command->kind == WTK_DL_FRAME) ? PS_INSIDEFRAME : PS_SOLID
+	      );
+	    HGDIOBJ original = SelectObject( dc, pen );
+	    if( command->kind == WTK_DL_LINE )
+	    {
+	      MoveToEx( dc, stroke->from.x, stroke->from.y, NULL );
+	      LineTo( dc, stroke->to.x, stroke->to.y );
+	    }
+	    else
+	    {
+	      HGDIOBJ brush = SelectObject( dc, GetStockObject( NULL_BRUSH ) );
+	      Rectangle( dc, command->bounds.left, command->bounds.top,
+		  command->bounds.right, command->bounds.bottom
+		);
+	      SelectObject( dc, brush );
+	    }
+	    SelectObject( dc, original );
+	    GdiCache::Release( pen );
+	  }
+	  break;
+
+	case WTK_DL_TEXT:
+	  { DisplayText *text = (DisplayText *)(command);
+	    SelectObject( dc, text->font );
+	    SetTextColor( dc, text->colour );
+	    TextCache::Draw( dc, command->bounds.left, command->bounds.top,
+		(const char *)(text + 1), text->length
+	      );
+	  }
+	  break;
+      }
+    }
+    SelectObject( dc, font );
+    SetBkMode( dc, mode );
+  }
+
+  DisplayList::~DisplayList()
+  {
+    /* Release the command buffer, and the measurement context.
+     */
+    if( Measure != NULL ) DeleteDC( Measure );
+    free( (void *)(Buffer) );
+  }
+}
+
+/* $RCSfile$: end of file */
@@ -0,0 +1,200 @@
+/*
+ * wtkdpi.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation of the DpiScale helpers, which support
+ * per-monitor DPI awareness, and of the ScaledFont class.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include "wtklite.h"
+
+namespace WTK
+{
+  /* The DPI awareness APIs are available only in more recent versions of
+   * Windows, so we must look them up dynamically; these are their types.
+   */
+  typedef BOOL (WINAPI *SetSystemAware)( void );
+  typedef BOOL (WINAPI *SetAwarenessContext)( HANDLE );
+  typedef HRESULT (WINAPI *SetAwareness)( int );
+  typedef HRESULT (WINAPI *GetMonitorDpi)( HMONITOR, int, UINT *, UINT * );
+
+  /* The value of DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2, and of the
+   * equivalent PROCESS_PER_MONITOR_DPI_AWARE, and MDT_EFFECTIVE_DPI, for
+   * use with those APIs.
+   */
+# define WTK_AWARENESS_CONTEXT_PMV2  ((HANDLE)(-4))
+# define WTK_PROCESS_PER_MONITOR      2
+# define WTK_EFFECTIVE_DPI	      0
+
+  HMONITOR DpiScale::Monitor[WTK_DPI_MONITORS_MAX];
+  UINT DpiScale::MonitorDpi[WTK_DPI_MONITORS_MAX];
+  unsigned int DpiScale::MonitorCount = 0;
+
+  static HMODULE ShellCore( void )
+  {
+    /* Local helper to load the shell core library, (once only), when
+     * it is available.
+     */
+    static HMODULE shcore = NULL; static bool loaded = false;
+    if( ! loaded ) { shcore = LoadLibrary( "shcore.dll" ); loaded = true; }
+    return shcore;
+  }
+
+  bool DpiScale::Enable()
+  {
+    /* Request per-monitor DPI awareness, preferring the v2 context, (as
+     * supported by Windows 10, from version 1703), then the Windows 8.1
+     * per-monitor mode, and finally settling for system DPI awareness;
+     * returns true, if per-monitor awareness is in effect.  (This has no
+     * effect, if awareness has already been established, either by an
+     * earlier call, or by the application manifest).
+     */
+    static int enabled = -1;
+    if( enabled >= 0 ) return enabled > 0;
+
+    HMODULE user = GetModuleHandle( "user32.dll" );
+    SetAwarenessContext set_context = (SetAwarenessContext)(GetProcAddress(
+	  user, "SetProcessDpiAwarenessContext"
+	));
+    if( (set_context != NULL) && set_context( WTK_AWARENESS_CONTEXT_PMV2 ) )
+      return (enabled = 1) > 0;
+
+    SetAwareness set_awareness = (ShellCore() == NULL) ? NULL
+      : (SetAwareness)(GetProcAddress( ShellCore(), "SetProcessDpiAwareness" ));
+    if( (set_awareness != NULL) && SUCCEEDED( set_awareness( WTK_PROCESS_PER_MONITOR ) ) )
+      return (enabled = 1) > 0;
+
+    SetSystemAware set_system = (SetSystemAware)(GetProcAddress( user, "SetProcessDPIAware" ));
+    if( set_system != NULL ) set_system();
+    return (enabled = 0) > 0;
+  }
+
+  static volatile LONG cache_lock = 0;
+
+  void DpiScale::Forget()
+  {
+    /* Discard all cached monitor DPI values, (e.g. on WM_DPICHANGED,
+     * or when the display configuration changes).
+     */
+    SpinLock hold( &cache_lock );
+    MonitorCount = 0;
+  }
+
+  static GetMonitorDpi MonitorDpiQuery( void )
+  {
+    /* Local helper to resolve GetDpiForMonitor(), (once only), when it
+     * is available; since this may load a library, it must not be called
+     * while the cache_lock is held.  (Concurrent first calls may each
+     * resolve it, but all will obtain the same result).
+     */
+    static GetMonitorDpi query = NULL; static volatile LONG resolved = 0;
+    if( resolved == 0 )
+    {
+      if( ShellCore() != NULL )
+	query = (GetMonitorDpi)(GetProcAddress( ShellCore(), "GetDpiForMonitor" ));
+      InterlockedExchange( &resolved, 1 );
+    }
+    return query;
+  }
+
+  UINT DpiScale::ForMonitor( HMONITOR monitor )
+  {
+    /* Retrieve the effective DPI of a specified monitor, from the cache
+     * if possible; otherwise query it, (falling back to the system DPI,
+     * when per-monitor DPI cannot be determined), and cache it; the
+     * cache may be shared by more than one user interface thread, but
+     * its lock is not held while the system is queried.
+     */
+    {
+      SpinLock hold( &cache_lock );
+      for( unsigned int i = 0; i < MonitorCount; i++ )
+	if( Monitor[i] == monitor ) return MonitorDpi[i];
+    }
+    UINT dpi = 0, unused;
+    GetMonitorDpi get_dpi = MonitorDpiQuery();
+    if( (get_dpi == NULL) || FAILED( get_dpi( monitor, WTK_EFFECTIVE_DPI, &dpi, &unused ) ) )
+    {
+      HDC screen = GetDC( NULL );
+      dpi = GetDeviceCaps( screen, LOGPIXELSY );
+      ReleaseDC( NULL, screen );
+    }
+    if( dpi == 0 ) dpi = USER_DEFAULT_SCREEN_DPI;
+
+    /* Another thread may have cached the same monitor, in the meantime;
+     * otherwise, when the cache is full, (which is unlikely, since it
+     * accommodates more monitors than most systems will ever have), simply
+     * replace its oldest entry.
+     */
+    SpinLock hold( &cache_lock );
+    for( unsigned int i = 0; i < MonitorCount; i++ )
+      if( Monitor[i] == monitor ) return MonitorDpi[i] = dpi;
+    unsigned int slot = MonitorCount;
+    if( slot < WTK_DPI_MONITORS_MAX ) ++MonitorCount;
+    else for( slot = 0; ++slot < WTK_DPI_MONITORS_MAX; )
+    { Monitor[slot - 1] = Monitor[slot]; MonitorDpi[slot - 1] = MonitorDpi[slot]; }
+    Monitor[--slot] = monitor; MonitorDpi[slot] = dpi;
+    return dpi;
+  }
+
+  UINT DpiScale::ForWindow( HWND window )
+  {
+    /* Retrieve the DPI of the monitor on which a window is displayed,
+     * (or on which it will be displayed, if it is not yet visible).
+     */
+    return ForMonitor( MonitorFromWindow( window, MONITOR_DEFAULTTONEAREST ) );
+  }
+
+  HFONT ScaledFont::For( UINT dpi )
+  {
+    /* Retrieve the font, as realised for a specified DPI, rebuilding it
+     * only if it has not yet been realised, or was last realised for some
+     * other DPI; (a reversion to a previous DPI may then be satisfied from
+     * the GdiCache, without recreating the font).
+     */
+    if( (Font == NULL) || (dpi != FontDpi) )
+    {
+      LOGFONT scaled = Design;
+      scaled.lfHeight = DpiScale::Scale( Design.lfHeight, dpi );
+      scaled.lfWidth = DpiScale::Scale( Design.lfWidth, dpi );
+      HFONT font = GdiCache::Font( &scaled );
+      if( Font != NULL ) GdiCache::Release( Font );
+      Font = font; FontDpi = dpi;
+    }
+    return Font;
+  }
+}
+
+/* $RCSfile$: end of file */
@@ -77,14 +77,15 @@ namespace WTK
   {
     /* A helper class to dynamically place message text, up to a
      * maximum of 256 characters, into a static buffer whence it
-     * may be retrieved on catching a runtime_error exception.
+     * may be retrieved on catching a runtime_error exception; each
+     * thread has its own buffer.
      */
     public:
       error_text( const char *, ... ) throw();
       operator const char *() const throw(){ return message; }
 
     private:
-      static char message[256];
+      static __thread char message[256];
   };
 }
 
@@ -0,0 +1,284 @@
+/*
+ * wtkfetch.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation for the ResourcePrefetcher class,
+ * which loads a manifest of icon, cursor, bitmap and string resources, in
+ * parallel on worker threads, and serves subsequent requests for any of
+ * these resources from its cache.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <string.h>
+#include <process.h>
+#include "wtklite.h"
+
+/* We create no more than this many worker threads, by default.
+ */
+#define WTK_PREFETCH_THREADS_MAX  4
+
+namespace WTK
+{
+  /* Each cache entry progresses through these states; an entry may
+   * be claimed for loading, by whichever thread reaches it first.
+   */
+  enum { ENTRY_PENDING, ENTRY_LOADING, ENTRY_RESOLVED };
+
+  struct PrefetchEntry
+  {
+    /* Cache entries are stored in an open addressed hash table; an
+     * entry with a zero type field represents an unused table slot.
+     */
+    unsigned int type;
+    unsigned int id;
+    volatile LONG state;
+    void * volatile value;
+  };
+
+  ResourcePrefetcher * volatile ResourcePrefetcher::Active = NULL;
+
+  static inline unsigned int hash( unsigned int type, unsigned int id )
+  {
+    /* Local helper to compute the initial hash table slot index; the
+     * caller must reduce it modulo the (power of two) table size.
+     */
+    return (id * 2654435761U) ^ (type * 40503U);
+  }
+
+  ResourcePrefetcher::ResourcePrefetcher( HINSTANCE app,
+      const ResourceManifest *manifest, unsigned int count, unsigned int threads
+  ): Module( app ), Entry( NULL ), TableSize( 2 ), ThreadCount( 0 ),
+  NextEntry( 0 ), Thread( NULL )
+  {
+    /* Construct the cache table, with at least twice as many slots
+     * as there are manifest entries...
+     */
+    if( Active != NULL )
+      throw( runtime_error( "Resource prefetcher is already active" ) );
+    while( TableSize < (count << 1) ) TableSize <<= 1;
+    if( (Entry = (PrefetchEntry *)(calloc( TableSize, sizeof( PrefetchEntry )))) == NULL )
+      throw( runtime_error( "Insufficient memory" ) );
+
+    /* ...and populate it, ignoring duplicate entries.
+     */
+    for( unsigned int i = 0; i < count; i++ )
+    {
+      unsigned int slot = hash( manifest[i].type, manifest[i].id );
+      while( Entry[slot &= TableSize - 1].type != 0 )
+      {
+	if( (Entry[slot].type == manifest[i].type) && (Entry[slot].id == manifest[i].id) )
+	  break;
+	++slot;
+      }
+      Entry[slot].type = manifest[i].type;
+      Entry[slot].id = manifest[i].id;
+    }
+    Active = this;
+
+    /* Unless otherwise specified, use one worker thread for each
+     * available processor, within a sensible upper limit; then start
+     * them, (but if none can be started, all resources will simply be
+     * loaded on demand, by the calling thread).
+     */
+    if( threads == 0 )
+    {
+      SYSTEM_INFO sys; GetSystemInfo( &sys );
+      threads = sys.dwNumberOfProcessors;
+      if( threads > WTK_PREFETCH_THREADS_MAX ) threads = WTK_PREFETCH_THREADS_MAX;
+    }
+    if( (Thread = (HANDLE *)(malloc( threads * sizeof( HANDLE )))) != NULL )
+      while( ThreadCount < threads )
+      {
+	HANDLE worker = (HANDLE)(_beginthreadex( NULL, 0, Worker, this, 0, NULL ));
+	if( worker == NULL ) break;
+	Thread[ThreadCount++] = worker;
+      }
+  }
+
+  unsigned __stdcall ResourcePrefetcher::Worker( void *owner )
+  {
+    /* Thread procedure for each worker; it repeatedly takes the next
+     * unvisited table slot, and loads the associated resource, unless
+     * some other thread has already claimed it.
+     */
+    ResourcePrefetcher *cache = (ResourcePrefetcher *)(owner);
+    StartupPhase phase( "ResourcePrefetcher" );
+    unsigned int slot;
+    while( (slot = InterlockedIncrement( &cache->NextEntry ) - 1) < cache->TableSize )
+      if( cache->Entry[slot].type != 0 ) cache->Resolve( cache->Entry + slot );
+    return 0;
+  }
+
+  void ResourcePrefetcher::Resolve( PrefetchEntry *entry )
+  {
+    /* Load the resource associated with a specified cache entry; if
+     * the entry has been claimed by another thread, wait for it to be
+     * resolved, (but there is nothing to do, if already resolved).
+     */
+    if( InterlockedCompareExchange( &entry->state, ENTRY_LOADING, ENTRY_PENDING ) != ENTRY_PENDING )
+    {
+      for( int retry = 0; entry->state != ENTRY_RESOLVED; ++retry )
+	Sleep( (retry < 16) ? 0 : 1 );
+      return;
+    }
+    HINSTANCE module = (entry->type & WTK_PREFETCH_SYSTEM) ? NULL : Module;
+    const char *name = MAKEINTRESOURCE( entry->id );
+    void *value = NULL;
+    switch( entry->type & ~WTK_PREFETCH_SYSTEM )
+    {
+      case WTK_PREFETCH_ICON:
+	value = (void *)(LoadIcon( module, name ));
+	break;
+
+      case WTK_PREFETCH_CURSOR:
+	value = (void *)(LoadCursor( module, name ));
+	break;
+
+      case WTK_PREFETCH_BITMAP:
+	value = (void *)(LoadBitmap( module, name ));
+	break;
+
+      case WTK_PREFETCH_STRING:
+	/* String resources are loaded into a maximally sized temporary
+	 * buffer, then copied to a permanent allocation of the exact
+	 * size required; (a NULL value indicates failure).
+	 */
+	char *tmp;
+	if( (tmp = (char *)(malloc( WTK_STRING_RESOURCE_MAX ))) != NULL )
+	{
+	  if( LoadString( module, entry->id, tmp, WTK_STRING_RESOURCE_MAX ) )
+	    value = (void *)(strdup( tmp ));
+	  free( (void *)(tmp) );
+	}
+    }
+    entry->value = value;
+    InterlockedExchange( &entry->state, ENTRY_RESOLVED );
+  }
+
+  PrefetchEntry *ResourcePrefetcher::Lookup
+  ( unsigned int type, HINSTANCE module, const char *name )
+  {
+    /* Look up a specified resource in the active cache, resolving it
+     * immediately if necessary; this returns NULL if the resource is
+     * not present in the manifest.
+     */
+    ResourcePrefetcher *cache = Active;
+    if( (cache == NULL) || ! IS_INTRESOURCE( name ) ) return NULL;
+    if( module == NULL ) type |= WTK_PREFETCH_SYSTEM;
+    else if( module != cache->Module ) return NULL;
+
+    unsigned int id = (unsigned int)((ULONG_PTR)(name));
+    unsigned int slot = hash( type, id );
+    while( cache->Entry[slot &= cache->TableSize - 1].type != 0 )
+    {
+      PrefetchEntry *entry = cache->Entry + slot++;
+      if( (entry->type == type) && (entry->id == id) )
+      {
+	cache->Resolve( entry );
+	return entry;
+      }
+    }
+    return NULL;
+  }
+
+  HICON ResourcePrefetcher::Icon( HINSTANCE module, const char *name )
+  {
+    /* Retrieve an icon from the cache, or load it directly.
+     */
+    PrefetchEntry *entry = Lookup( WTK_PREFETCH_ICON, module, name );
+    return ((entry != NULL) && (entry->value != NULL))
+      ? (HICON)(entry->value) : LoadIcon( module, name );
+  }
+
+  HCURSOR ResourcePrefetcher::Cursor( HINSTANCE module, const char *name )
+  {
+    /* Retrieve a cursor from the cache, or load it directly.
+     */
+    PrefetchEntry *entry = Lookup( WTK_PREFETCH_CURSOR, module, name );
+    return ((entry != NULL) && (entry->value != NULL))
+      ? (HCURSOR)(entry->value) : LoadCursor( module, name );
+  }
+
+  HBITMAP ResourcePrefetcher::Bitmap( HINSTANCE module, const char *name )
+  {
+    /* Retrieve a bitmap from the cache, relinquishing ownership, or
+     * load it directly, if it is no longer cached.
+     */
+    HBITMAP bitmap = NULL;
+    PrefetchEntry *entry = Lookup( WTK_PREFETCH_BITMAP, module, name );
+    if( entry != NULL ) bitmap = (HBITMAP)(InterlockedExchangePointer( &entry->value, NULL ));
+    return (bitmap != NULL) ? bitmap : LoadBitmap( module, name );
+  }
+
+  const char *ResourcePrefetcher::String( HINSTANCE module, unsigned int id )
+  {
+    /* Retrieve a string from the cache; unlike the other retrieval
+     * methods, this does not load uncached resources directly, but
+     * returns NULL, leaving the caller to load the string itself.
+     */
+    PrefetchEntry *entry = Lookup( WTK_PREFETCH_STRING, module, MAKEINTRESOURCE( id ));
+    return (entry != NULL) ? (const char *)(entry->value) : NULL;
+  }
+
+  ResourcePrefetcher::~ResourcePrefetcher()
+  {
+    /* Deactivate the cache, and wait for all worker threads to finish;
+     * release all cached strings, (so invalidating any pointer which
+     * String() has returned), and any bitmaps which have not been
+     * retrieved; (icons and cursors are shared, and must not be freed).
+     */
+    Active = NULL;
+    if( ThreadCount > 0 )
+    {
+      WaitForMultipleObjects( ThreadCount, Thread, TRUE, INFINITE );
+      while( ThreadCount > 0 ) CloseHandle( Thread[--ThreadCount] );
+    }
+    free( (void *)(Thread) );
+    for( unsigned int i = 0; i < TableSize; i++ )
+      if( (Entry[i].state == ENTRY_RESOLVED) && (Entry[i].value != NULL) )
+	switch( Entry[i].type & ~WTK_PREFETCH_SYSTEM )
+	{
+	  case WTK_PREFETCH_BITMAP:
+	    DeleteObject( (HGDIOBJ)(Entry[i].value) );
+	    break;
+
+	  case WTK_PREFETCH_STRING:
+	    free( Entry[i].value );
+	}
+    free( (void *)(Entry) );
+  }
+}
+
+/* $RCSfile$: end of file */
@@ -0,0 +1,266 @@
+/*
+ * wtkgdi.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation for the GdiCache class, which shares
+ * reference counted GDI brushes, pens and fonts, keyed by the attributes from
+ * which each was created, and retains unreferenced objects for later reuse.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <string.h>
+#include "wtklite.h"
+
+/* The number of hash chains, (a power of two), used to look up cached
+ * objects, both by attributes, and by handle.
+ */
+#define WTK_GDICACHE_BUCKETS  64
+
+namespace WTK
+{
+  enum { WTK_GDI_BRUSH, WTK_GDI_PEN, WTK_GDI_FONT };
+
+  struct GdiPenKey
+  {
+    /* The attributes which identify a cached pen.
+     */
+    COLORREF colour;
+    int width, style;
+  };
+
+  struct GdiCacheEntry
+  {
+    /* Each cached object is recorded with the attributes from which it
+     * was created, (in a form suitable for bytewise comparison), and is
+     * linked into a hash chain by attributes, a hash chain by handle and,
+     * while unreferenced, the list of idle objects, most recent first.
+     */
+    int kind; size_t size;
+    unsigned long hash;
+    union { COLORREF colour; LOGFONT font; unsigned char bytes[1]; } key;
+    HGDIOBJ object; unsigned long refs;
+    GdiCacheEntry *chain, *handle_chain, *newer, *older;
+  };
+
+  GdiCacheEntry *GdiCache::Bucket[WTK_GDICACHE_BUCKETS];
+  GdiCacheEntry *GdiCache::Handle[WTK_GDICACHE_BUCKETS];
+  GdiCacheEntry *GdiCache::Newest = NULL;
+  GdiCacheEntry *GdiCache::Oldest = NULL;
+  unsigned int GdiCache::Capacity = WTK_GDICACHE_RETAIN;
+  unsigned int GdiCache::ObjectCount = 0;
+  unsigned int GdiCache::IdleCount = 0;
+  unsigned long GdiCache::HitCount = 0;
+  unsigned long GdiCache::MissCount = 0;
+
+  /* All access to the cache is serialised, since it may be shared by
+   * more than one user interface thread.
+   */
+  static volatile LONG cache_lock = 0;
+
+  static inline unsigned int HandleHash( HGDIOBJ object )
+  {
+    /* Helper to select the handle chain for a GDI object.
+     */
+    return (unsigned int)((ULONG_PTR)(object) >> 4) & (WTK_GDICACHE_BUCKETS - 1);
+  }
+
+  HBRUSH GdiCache::Brush( COLORREF colour )
+  {
+    /* Acquire a reference to a solid brush of specified colour.
+     */
+    return (HBRUSH)(Acquire( WTK_GDI_BRUSH, &colour, sizeof( colour ) ));
+  }
+
+  HPEN GdiCache::Pen( COLORREF colour, int width, int style )
+  {
+    /* Acquire a reference to a pen of specified colour, width and style.
+     */
+    GdiPenKey key = { colour, width, style };
+    return (HPEN)(Acquire( WTK_GDI_PEN, &key, sizeof( key ) ));
+  }
+
+  HFONT GdiCache::Font( const LOGFONT *font )
+  {
+    /* Acquire a reference to a font matching a LOGFONT specification;
+     * any residual content following the face name is disregarded.
+     */
+    LOGFONT key = *font;
+    size_t len = 0; while( (len < LF_FACESIZE) && key.lfFaceName[len] ) ++len;
+    memset( key.lfFaceName + len, 0, LF_FACESIZE - len );
+    return (HFONT)(Acquire( WTK_GDI_FONT, &key, sizeof( key ) ));
+  }
+
+  HGDIOBJ GdiCache::Acquire( int kind, const void *key, size_t size )
+  {
+    /* Helper to look up an object of a specified kind, by attributes,
+     * creating it if it is not already cached.
+     */
+    SpinLock hold( &cache_lock );
+    unsigned long hash = 2166136261UL ^ kind;
+    for( size_t i = 0; i < size; i++ )
+      hash = (hash ^ ((const unsigned char *)(key))[i]) * 16777619UL;
+
+    GdiCacheEntry *entry = Bucket[hash & (WTK_GDICACHE_BUCKETS - 1)];
+    while( (entry != NULL) && ((entry->hash != hash) || (entry->kind != kind)
+	|| (entry->size != size) || (memcmp( entry->key.bytes, key, size ) != 0)) )
+      entry = entry->chain;
+
+    if( entry != NULL )
+    {
+      /* The object is cached; if it was idle, it no longer is.
+       */
+      if( entry->refs++ == 0 ) { Unlink( entry ); --IdleCount; }
+      ++HitCount;
+      return entry->object;
+    }
+
+    /* The object must be created, and added to the cache.
+     */
+    HGDIOBJ object;
+    switch( kind )
+    {
+      case WTK_GDI_BRUSH:
+	object = CreateSolidBrush( *(const COLORREF *)(key) );
+	break;
+
+      case WTK_GDI_PEN:
+	{ const GdiPenKey *pen = (const GdiPenKey *)(key);
+	  object = CreatePen( pen->style, pen->width, pen->colour );
+	}
+	break;
+
+      default:
+	object = CreateFontIndirect( (const LOGFONT *)(key) );
+    }
+    if( object == NULL ) return NULL;
+    if( (entry = (GdiCacheEntry *)(malloc( sizeof( GdiCacheEntry )))) == NULL )
+    {
+      DeleteObject( object );
+      throw( runtime_error( "Insufficient memory" ) );
+    }
+    entry->kind = kind; entry->size = size; entry->hash = hash;
+    memcpy( entry->key.bytes, key, size );
+    entry->object = object; entry->refs = 1;
+    entry->newer = entry->older = NULL;
+    entry->chain = Bucket[hash & (WTK_GDICACHE_BUCKETS - 1)];
+    Bucket[hash & (WTK_GDICACHE_BUCKETS - 1)] = entry;
+    entry->handle_chain = Handle[HandleHash( object )];
+    Handle[HandleHash( object )] = entry;
+    ++ObjectCount; ++MissCount;
+    return object;
+  }
+
+  void GdiCache::Release( HGDIOBJ object )
+  {
+    /* Return a reference to a cached object; when its last reference is
+     * returned, the object becomes idle, but is retained, (unless that
+     * would exceed the limit on idle objects).  References to objects
+     * which did not originate from the cache are ignored.
+     */
+    SpinLock hold( &cache_lock );
+    GdiCacheEntry *entry = Handle[HandleHash( object )];
+    while( (entry != NULL) && (entry->object != object) ) entry = entry->handle_chain;
+    if( (entry != NULL) && (entry->refs > 0) && (--entry->refs == 0) )
+    {
+      if( (entry->older = Newest) != NULL ) Newest->newer = entry;
+      else Oldest = entry;
+      Newest = entry; ++IdleCount;
+      Trim( Capacity );
+    }
+  }
+
+  void GdiCache::Unlink( GdiCacheEntry *entry )
+  {
+    /* Helper to remove an entry from the list of idle objects.
+     */
+    if( entry->newer != NULL ) entry->newer->older = entry->older;
+    else Newest = entry->older;
+    if( entry->older != NULL ) entry->older->newer = entry->newer;
+    else Oldest = entry->newer;
+    entry->newer = entry->older = NULL;
+  }
+
+  void GdiCache::Delete( GdiCacheEntry *entry )
+  {
+    /* Helper to delete an idle object, and discard its cache entry.
+     */
+    GdiCacheEntry **ref;
+    Unlink( entry ); --IdleCount;
+    for( ref = Bucket + (entry->hash & (WTK_GDICACHE_BUCKETS - 1)); *ref != entry; )
+      ref = &((*ref)->chain);
+    *ref = entry->chain;
+    for( ref = Handle + HandleHash( entry->object ); *ref != entry; )
+      ref = &((*ref)->handle_chain);
+    *ref = entry->handle_chain;
+    if( entry->kind == WTK_GDI_FONT ) TextCache::Forget( (HFONT)(entry->object) );
+    DeleteObject( entry->object ); free( (void *)(entry) );
+    --ObjectCount;
+  }
+
+  void GdiCache::Trim( unsigned int limit )
+  {
+    /* Helper to delete the least recently released idle objects, until
+     * no more than a specified number remain.
+     */
+    while( IdleCount > limit ) Delete( Oldest );
+  }
+
+  void GdiCache::SetCapacity( unsigned int limit )
+  {
+    /* Adjust the limit on the number of idle objects retained.
+     */
+    SpinLock hold( &cache_lock );
+    Trim( Capacity = limit );
+  }
+
+  void GdiCache::Purge()
+  {
+    /* Delete all idle objects, (e.g. when the system colours, or the
+     * display resolution, change).
+     */
+    SpinLock hold( &cache_lock );
+    Trim( 0 );
+  }
+
+  DWORD GdiCache::HandleCount()
+  {
+    /* Report the number of GDI handles currently held by the process,
+     * for comparison with the system imposed quota.
+     */
+    return GetGuiResources( GetCurrentProcess(), GR_GDIOBJECTS );
+  }
+}
+
+/* $RCSfile$: end of file */
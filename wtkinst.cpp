@@ -0,0 +1,194 @@
+/*
+ * wtkinst.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation for the SingleInstance class,
+ * which uses a named mutex to detect any already running instance of an
+ * application, and a named shared memory region, to forward the command
+ * line of any subsequently started instance, to the running instance.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <stdio.h>
+#include <string.h>
+#include "wtklite.h"
+
+/* The maximum length of a command line which may be forwarded, (the
+ * documented limit for CreateProcess(), including the terminating NUL).
+ */
+#define WTK_INSTANCE_ARGS_MAX  32768
+
+namespace WTK
+{
+  /* Possible states of the shared request buffer; the buffer may be
+   * claimed only when it is vacant, by the instance which is to write
+   * a request into it, after which it must be marked as ready, before
+   * signalling the primary instance to read it.
+   */
+  enum { REQUEST_VACANT, REQUEST_WRITING, REQUEST_READY, REQUEST_READING };
+
+  struct SharedRequest
+  {
+    /* The layout of the shared memory region; the window handle is
+     * stored as a DWORD, since only its low order 32-bits are valid
+     * across process boundaries.
+     */
+    volatile LONG state;
+    DWORD window;
+    char args[WTK_INSTANCE_ARGS_MAX];
+  };
+
+  static HANDLE create_object( const char *fmt, const char *name, int type )
+  {
+    /* Local helper to create, or open, a named kernel object whose
+     * name is derived from the application specified name.
+     */
+    char id[1 + snprintf( NULL, 0, fmt, name )];
+    snprintf( id, sizeof( id ), fmt, name );
+    switch( type )
+    {
+      case 'M': return CreateMutex( NULL, TRUE, id );
+      case 'E': return CreateEvent( NULL, FALSE, FALSE, id );
+    }
+    return CreateFileMapping( INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+	0, sizeof( SharedRequest ), id
+      );
+  }
+
+  SingleInstance::SingleInstance( const char *name ):
+  Mapping( NULL ), Request( NULL ), Shared( NULL ), Owner( NULL )
+  {
+    /* The first instance to create the named mutex becomes the primary
+     * instance; (we must check the error status immediately, before it
+     * may be overwritten by any other API call).
+     */
+    Mutex = create_object( "Local\\%s.instance", name, 'M' );
+    Primary = (Mutex != NULL) && (GetLastError() != ERROR_ALREADY_EXISTS);
+
+    /* Irrespective of which instance creates them, all instances share
+     * the same request buffer, and the same request notification event.
+     */
+    if( ((Mapping = create_object( "Local\\%s.request", name, 'F' )) == NULL)
+    ||  ((Shared = (SharedRequest *)(MapViewOfFile( Mapping,
+	    FILE_MAP_ALL_ACCESS, 0, 0, sizeof( SharedRequest )))) == NULL)
+    ||  ((Request = create_object( "Local\\%s.signal", name, 'E' )) == NULL)  )
+    {
+      /* We cannot proceed, if any of these is unavailable; clean up
+       * any which have been successfully created, and bail out.
+       */
+      Release();
+      throw( runtime_error( "Single instance initialisation FAILED" ) );
+    }
+  }
+
+  void SingleInstance::Attach( MainWindowMaker *owner, HWND window )
+  {
+    /* Called by the primary instance, to identify the window which
+     * is to be raised by any other instance, and to attach the request
+     * notification event to the message loop of that window.
+     */
+    if( Primary )
+    {
+      Shared->window = (DWORD)((ULONG_PTR)(window));
+      (Owner = owner)->AttachMonitor( this );
+    }
+  }
+
+  bool SingleInstance::Forward( const char *args )
+  {
+    /* Called by any secondary instance, to pass its command line to
+     * the primary instance; first, we must claim the request buffer,
+     * which may be transiently in use, (if multiple instances have
+     * been started concurrently); we wait for no more than about one
+     * second, before giving up.
+     */
+    for( int retry = 0; InterlockedCompareExchange( &Shared->state,
+	  REQUEST_WRITING, REQUEST_VACANT ) != REQUEST_VACANT; ++retry )
+    {
+      if( retry > 1000 ) return false;
+      Sleep( (retry < 10) ? 0 : 1 );
+    }
+
+    /* Having claimed the buffer, copy in the command line, (truncated
+     * to fit, if necessary), publish it, and notify the primary.
+     */
+    strncpy( Shared->args, args ? args : "", WTK_INSTANCE_ARGS_MAX );
+    Shared->args[WTK_INSTANCE_ARGS_MAX - 1] = '\0';
+    InterlockedExchange( &Shared->state, REQUEST_READY );
+    SetEvent( Request );
+
+    /* Finally, bring the primary instance's window to foreground;
+     * (this must be done by the secondary instance, since only it
+     * is entitled to take the foreground).
+     */
+    RaiseWindow( (HWND)((ULONG_PTR)(Shared->window)) );
+    return true;
+  }
+
+  void SingleInstance::OnSignalled()
+  {
+    /* Invoked within the primary instance's message loop, when any
+     * secondary instance has forwarded a request; provided the request
+     * is complete, we pass it to the handler in place, then release the
+     * buffer for reuse.
+     */
+    if( InterlockedCompareExchange( &Shared->state,
+	  REQUEST_READING, REQUEST_READY ) == REQUEST_READY )
+    {
+      OnForwardedRequest( Shared->args );
+      InterlockedExchange( &Shared->state, REQUEST_VACANT );
+    }
+  }
+
+  void SingleInstance::Release()
+  {
+    /* Helper, called by the destructor, (or by the constructor, on
+     * failure), to detach from the message loop, if necessary, and to
+     * release all shared resources; ownership of the mutex is to be
+     * relinquished only by the primary instance.
+     */
+    if( Owner != NULL ) Owner->DetachMonitor( this );
+    if( Shared != NULL ) UnmapViewOfFile( Shared );
+    if( Mapping != NULL ) CloseHandle( Mapping );
+    if( Request != NULL ) CloseHandle( Request );
+    if( Mutex != NULL )
+    {
+      if( Primary ) ReleaseMutex( Mutex );
+      CloseHandle( Mutex );
+    }
+  }
+}
+
+/* $RCSfile$: end of file */
@@ -0,0 +1,280 @@
+/*
+ * wtklane.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation of the MessageLanes class, which
+ * queues application defined messages in several priority lanes, and
+ * delivers them from the message loop by weighted round robin, always in
+ * deference to pending user input.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <stdlib.h>
+#include "wtklite.h"
+
+namespace WTK
+{
+  static const unsigned int default_weight[WTK_LANES] = { 8, 3, 1 };
+
+  MessageLanes::MessageLanes(): Window( NULL ), Signalled( 0 ), YieldCount( 0 )
+  {
+    /* All lanes are initially empty; the wake message is registered, so
+     * that it cannot collide with any message which the application may
+     * define for itself.
+     */
+    for( unsigned int lane = 0; lane < WTK_LANES; lane++ )
+    {
+      Lane[lane].head = Lane[lane].tail = NULL; Lane[lane].depth = 0;
+      Lane[lane].weight = default_weight[lane]; Lane[lane].served = 0;
+      Lane[lane].total_wait = Lane[lane].max_wait = 0;
+    }
+    LARGE_INTEGER frequency; QueryPerformanceFrequency( &frequency );
+    Frequency = frequency.QuadPart;
+    WakeMessage = RegisterWindowMessage( "WTK_MessageLanes_Wake" );
+    InitializeCriticalSection( &Lock );
+  }
+
+  MessageLanes::~MessageLanes()
+  {
+    /* Discard any items which remain undelivered.
+     */
+    Attach( NULL );
+    for( unsigned int lane = 0; lane < WTK_LANES; lane++ )
+      while( Lane[lane].head != NULL )
+      {
+	LaneItem *item = Lane[lane].head;
+	Lane[lane].head = item->next; free( item );
+      }
+    DeleteCriticalSection( &Lock );
+  }
+
+  bool MessageLanes::Post
+  ( unsigned int lane, HWND window, UINT message, WPARAM w_param, LPARAM l_param )
+  {
+    /* Append an item to the specified lane, (from any thread), and raise
+     * the wake signal, unless it is already pending.
+     */
+    if( lane >= WTK_LANES ) return false;
+    LaneItem *item = (LaneItem *)(malloc( sizeof( LaneItem ) ));
+    if( item == NULL ) return false;
+
+    LARGE_INTEGER clock; QueryPerformanceCounter( &clock );
+    item->next = NULL; item->window = window; item->message = message;
+    item->w_param = w_param; item->l_param = l_param;
+    item->posted = clock.QuadPart;
+
+    EnterCriticalSection( &Lock );
+    if( Lane[lane].tail == NULL ) Lane[lane].head = item;
+    else Lane[lane].tail->next = item;
+    Lane[lane].tail = item;
+    InterlockedIncrement( &Lane[lane].depth );
+    LeaveCriticalSection( &Lock );
+
+    Wake();
+    return true;
+  }
+
+  void MessageLanes::Wake()
+  {
+    /* Helper to post the wake message, only on transition of the signal
+     * from clear to raised; if the window's queue cannot accept it, the
+     * signal is cleared again, so that the next Post() will retry.
+     */
+    HWND window = Window;
+    if( (InterlockedExchange( &Signalled, 1 ) == 0) && (window != NULL)
+    &&  ! PostMessage( window, WakeMessage, 0, 0 )  )
+      InterlockedExchange( &Signalled, 0 );
+  }
+
+  MessageLanes::LaneItem *MessageLanes::Take( unsigned int lane )
+  {
+    /* Helper to remove the item at the head of a specified lane.
+     */
+    EnterCriticalSection( &Lock );
+    LaneItem *item = Lane[lane].head;
+    if( item != NULL )
+    {
+      if( (Lane[lane].head = item->next) == NULL ) Lane[lane].tail = NULL;
+      InterlockedDecrement( &Lane[lane].depth );
+    }
+    LeaveCriticalSection( &Lock );
+    return item;
+  }
+
+  void MessageLanes::Attach( HWND window )
+  {
+    /* Nominate the window which is to receive the wake message; any
+     * items which were posted while no window was attached are announced
+     * immediately.
+     */
+    if( Window != NULL ) KillTimer( Window, WTK_LANE_TIMER_ID );
+    InterlockedExchange( &Signalled, 0 ); Window = window;
+    if( window != NULL )
+      for( unsigned int lane = 0; lane < WTK_LANES; lane++ )
+	if( Lane[lane].depth > 0 ) { Wake(); return; }
+  }
+
+  bool MessageLanes::Handle( unsigned message, WPARAM w_param )
+  {
+    /* Filter for the attached window's Controller(); we consume both the
+     * wake message, and the timer by which draining is resumed, after
+     * deferring to user input.
+     */
+    if( message == WM_TIMER && w_param == WTK_LANE_TIMER_ID )
+      KillTimer( Window, WTK_LANE_TIMER_ID );
+
+    else if( (message != WakeMessage) || (WakeMessage == 0) )
+      return false;
+
+    Drain();
+    return true;
+  }
+
+  void MessageLanes::SetWeight( unsigned int lane, unsigned int weight )
+  {
+    /* Adjust the number of items served from a lane, in each round; every
+     * lane is served at least once per round, so that none may starve.
+     */
+    if( lane < WTK_LANES ) Lane[lane].weight = (weight > 0) ? weight : 1;
+  }
+
+  unsigned int MessageLanes::Drain()
+  {
+    /* Deliver queued items, on the user interface thread.  Each round
+     * grants every lane credit equal to its weight, and we always serve the
+     * highest priority lane which has both items and credit remaining; after
+     * each delivery, we yield if any input, or painting, is waiting, or if
+     * the time slice has expired, rescheduling ourself to resume thereafter.
+     * The wake signal is cleared first, so that any item posted while we
+     * are draining will raise it again.
+     */
+    InterlockedExchange( &Signalled, 0 );
+    LARGE_INTEGER clock; QueryPerformanceCounter( &clock );
+    LONGLONG deadline = clock.QuadPart + Frequency * WTK_LANE_SLICE / 1000;
+    unsigned int served = 0, credit[WTK_LANES] = { 0 }, lane;
+
+    while( true )
+    {
+      bool pending = false;
+      for( lane = 0; lane < WTK_LANES; lane++ )
+	if( Lane[lane].depth > 0 ) { pending = true; if( credit[lane] > 0 ) break; }
+
+      if( ! pending ) return served;
+      if( lane == WTK_LANES )
+      {
+	/* Items remain, but no lane which holds any has credit; begin
+	 * a new round.
+	 */
+	for( lane = 0; lane < WTK_LANES; lane++ ) credit[lane] = Lane[lane].weight;
+	continue;
+      }
+
+      if( served > 0 )
+      {
+	/* At least one item is always delivered, on each call, so that even
+	 * a continuous stream of input cannot stall the lanes indefinitely;
+	 * thereafter, we yield to input and painting, by way of a timer,
+	 * (whose message is not retrieved while either is pending), or, at
+	 * the end of the time slice, by posting a fresh wake message.
+	 */
+	DWORD waiting = HIWORD( GetQueueStatus( QS_INPUT | QS_PAINT ) );
+	QueryPerformanceCounter( &clock );
+	if( (waiting != 0) || (clock.QuadPart >= deadline) )
+	{
+	  if( Window == NULL ) return served;
+	  if( waiting == 0 ) Wake();
+	  else
+	  {
+	    ++YieldCount; InterlockedExchange( &Signalled, 1 );
+	    SetTimer( Window, WTK_LANE_TIMER_ID, USER_TIMER_MINIMUM, NULL );
+	  }
+	  return served;
+	}
+      }
+
+      --credit[lane];
+      LaneItem *item = Take( lane );
+      if( item == NULL ) continue;
+
+      /* Record the time for which the item was queued, then release it
+       * before delivery, since its recipient may re-enter the message loop.
+       */
+      QueryPerformanceCounter( &clock );
+      LONGLONG wait = clock.QuadPart - item->posted;
+      LaneState *ref = Lane + lane; ++ref->served; ref->total_wait += wait;
+      if( wait > ref->max_wait ) ref->max_wait = wait;
+
+      HWND window = (item->window != NULL) ? item->window : Window;
+      UINT message = item->message; WPARAM w_param = item->w_param;
+      LPARAM l_param = item->l_param; free( item );
+
+      if( window != NULL ) SendMessage( window, message, w_param, l_param );
+      ++served;
+    }
+  }
+
+  double MessageLanes::MeanWait( unsigned int lane )
+  {
+    /* Mean queueing time, in milliseconds, of items served from a lane.
+     */
+    if( (lane >= WTK_LANES) || (Lane[lane].served == 0) ) return 0.0;
+    return (double)(Lane[lane].total_wait) * 1000.0
+      / ((double)(Frequency) * Lane[lane].served);
+  }
+
+  double MessageLanes::MaxWait( unsigned int lane )
+  {
+    /* Longest queueing time, in milliseconds, of any item served from
+     * a lane, since the statistics were last reset.
+     */
+    if( lane >= WTK_LANES ) return 0.0;
+    return (double)(Lane[lane].max_wait) * 1000.0 / (double)(Frequency);
+  }
+
+  void MessageLanes::ResetStatistics()
+  {
+    /* Clear the accumulated service statistics; queue depths, which
+     * reflect current state, are unaffected.
+     */
+    for( unsigned int lane = 0; lane < WTK_LANES; lane++ )
+    {
+      Lane[lane].served = 0;
+      Lane[lane].total_wait = Lane[lane].max_wait = 0;
+    }
+    YieldCount = 0;
+  }
+}
+
+/* $RCSfile$: end of file */
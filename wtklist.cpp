@@ -0,0 +1,290 @@
+/*
+ * wtklist.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation for the VirtualListWindow class,
+ * which presents the content of a VirtualListSource, in a list view control
+ * operating in owner data mode, through a least recently used row cache.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <string.h>
+#include "wtklite.h"
+#include <commctrl.h>
+
+/* Older versions of commctrl.h may not define the double buffering
+ * extended style; (it is simply ignored, where unsupported).
+ */
+#ifndef LVS_EX_DOUBLEBUFFER
+#define LVS_EX_DOUBLEBUFFER  0x00010000
+#endif
+
+/* A marker for the end of any cache chain, or LRU list.
+ */
+#define WTK_LIST_NIL  (~0U)
+
+namespace WTK
+{
+  struct VirtualListRow
+  {
+    /* Each row cache entry holds the text for all columns of one row,
+     * as a sequence of NUL terminated strings in a single allocation;
+     * entries are linked into both a hash chain, and a doubly linked
+     * list, ordered by most recent use.
+     */
+    unsigned long row;
+    char *text;
+    unsigned int chain, newer, older;
+  };
+
+  VirtualListWindow::VirtualListWindow
+  ( HINSTANCE app, VirtualListSource *source, unsigned int rows ):
+  ChildWindowMaker( app ), Source( source ), ColumnCount( 0 ), BucketMask( 1 ),
+  Hits( 0 ), Misses( 0 )
+  {
+    /* Allocate the row cache, with at least the specified number of
+     * entries, and twice as many hash chains.
+     */
+    if( (CacheSize = rows) < 2 ) CacheSize = 2;
+    while( BucketMask < (CacheSize << 1) ) BucketMask <<= 1;
+    Row = (VirtualListRow *)(malloc( CacheSize * sizeof( VirtualListRow )));
+    Bucket = (unsigned int *)(malloc( BucketMask-- * sizeof( unsigned int )));
+    if( (Row == NULL) || (Bucket == NULL) )
+    {
+      free( (void *)(Row) ); free( (void *)(Bucket) );
+      throw( runtime_error( "Insufficient memory" ) );
+    }
+    for( unsigned int i = 0; i < CacheSize; i++ ) Row[i].text = NULL;
+    Flush();
+  }
+
+  HWND VirtualListWindow::Create( int id, HWND parent, unsigned long style )
+  {
+    /* Create the list view control; since it does not use our window
+     * procedure, we must explicitly associate it with this object, before
+     * asking the parent to reflect the control's notifications to it.
+     */
+    ChildWindowMaker::Create( id, parent, WC_LISTVIEW,
+	style | LVS_REPORT | LVS_OWNERDATA | LVS_SHOWSELALWAYS
+      );
+    SetWindowLongPtr( AppWindow, GWLP_USERDATA, (LONG_PTR)(this) );
+    SendMessage( AppWindow, LVM_SETEXTENDEDLISTVIEWSTYLE, 0,
+	LVS_EX_FULLROWSELECT | LVS_EX_DOUBLEBUFFER
+      );
+    GenericWindow *owner = WindowObjectReference( parent );
+    if( owner != NULL ) owner->ReflectNotification( this );
+    Refresh();
+    return AppWindow;
+  }
+
+  void VirtualListWindow::Defer( int id, HWND parent, unsigned long style )
+  {
+    /* Record a deferred creation request, for the list view control;
+     * Realise() will then delegate to Create(), via OnRealise().
+     */
+    ChildWindowMaker::Defer( id, parent, WC_LISTVIEW, style );
+  }
+
+  int VirtualListWindow::AddColumn( const char *title, int width )
+  {
+    /* Append a column to the report view; since cached rows do not
+     * include text for this new column, they must all be discarded.
+     */
+    LVCOLUMN column;
+    column.mask = LVCF_TEXT | LVCF_WIDTH | LVCF_SUBITEM;
+    column.pszText = (char *)(title);
+    column.cx = width; column.iSubItem = ColumnCount;
+    int index = SendMessage( AppWindow, LVM_INSERTCOLUMN, ColumnCount, (LPARAM)(&column) );
+    if( index >= 0 ) { ++ColumnCount; Flush(); }
+    return index;
+  }
+
+  void VirtualListWindow::Flush()
+  {
+    /* Helper to discard all cached rows, resetting all hash chains to
+     * empty, and placing all cache entries in an arbitrary LRU order.
+     */
+    for( unsigned int i = 0; i <= BucketMask; i++ ) Bucket[i] = WTK_LIST_NIL;
+    for( unsigned int i = 0; i < CacheSize; i++ )
+    {
+      free( (void *)(Row[i].text) ); Row[i].text = NULL;
+      Row[i].newer = i ? i - 1 : WTK_LIST_NIL;
+      Row[i].older = (i < (CacheSize - 1)) ? i + 1 : WTK_LIST_NIL;
+    }
+    MostRecent = 0; LeastRecent = CacheSize - 1;
+  }
+
+  void VirtualListWindow::Refresh()
+  {
+    /* Discard all cached rows, and reset the item count; the control
+     * retains its scroll position, but repaints all visible rows.
+     */
+    Flush();
+    if( AppWindow != NULL )
+    {
+      SendMessage( AppWindow, LVM_SETITEMCOUNT, Source->RowCount(), LVSICF_NOSCROLL );
+      InvalidateRect( AppWindow, NULL, FALSE );
+    }
+  }
+
+  void VirtualListWindow::Discard( unsigned int entry )
+  {
+    /* Helper to remove a specified entry from its hash chain, and to
+     * release its text; it remains in its current LRU list position.
+     */
+    if( Row[entry].text != NULL )
+    {
+      unsigned int *ref = Bucket + (Row[entry].row & BucketMask);
+      while( *ref != entry ) ref = &(Row[*ref].chain);
+      *ref = Row[entry].chain;
+      free( (void *)(Row[entry].text) ); Row[entry].text = NULL;
+    }
+  }
+
+  void VirtualListWindow::Promote( unsigned int entry )
+  {
+    /* Helper to move a specified entry to the head of the LRU list.
+     */
+    if( entry != MostRecent )
+    {
+      Row[Row[entry].newer].older = Row[entry].older;
+      if( Row[entry].older != WTK_LIST_NIL ) Row[Row[entry].older].newer = Row[entry].newer;
+      else LeastRecent = Row[entry].newer;
+      Row[entry].newer = WTK_LIST_NIL; Row[entry].older = MostRecent;
+      Row[MostRecent].newer = entry; MostRecent = entry;
+    }
+  }
+
+  VirtualListRow *VirtualListWindow::Fetch( unsigned long row )
+  {
+    /* Helper to retrieve a specified row from the cache, or failing
+     * that, from the data source, (evicting the least recently used
+     * cache entry, to accommodate it); returns NULL, only if there is
+     * insufficient memory to retrieve it.
+     */
+    unsigned int entry = Bucket[row & BucketMask];
+    while( (entry != WTK_LIST_NIL) && (Row[entry].row != row) ) entry = Row[entry].chain;
+    if( entry != WTK_LIST_NIL ) ++Hits;
+
+    else
+    {
+      /* The row is not cached; retrieve the text for each column, in
+       * turn, into a maximally sized buffer, then compact it.
+       */
+      char *text, *ref; ++Misses;
+      if( (ref = text = (char *)(malloc( (ColumnCount ? ColumnCount : 1) * WTK_LIST_TEXT_MAX ))) == NULL )
+	return NULL;
+      *ref = '\0';
+      for( int column = 0; column < ColumnCount; column++ )
+      {
+	Source->FetchText( row, column, ref, WTK_LIST_TEXT_MAX );
+	ref[WTK_LIST_TEXT_MAX - 1] = '\0'; ref += strlen( ref ) + 1;
+      }
+      if( (ref = (char *)(realloc( text, ref - text + 1 ))) != NULL ) text = ref;
+
+      /* Recycle the least recently used entry, to hold it.
+       */
+      Discard( entry = LeastRecent );
+      Row[entry].row = row; Row[entry].text = text;
+      Row[entry].chain = Bucket[row & BucketMask]; Bucket[row & BucketMask] = entry;
+    }
+    Promote( entry );
+    return Row + entry;
+  }
+
+  void VirtualListWindow::Invalidate( unsigned long first, unsigned long last )
+  {
+    /* Discard any cached rows within a specified range, and redraw
+     * them, (to the extent that they are visible).
+     */
+    for( unsigned int i = 0; i < CacheSize; i++ )
+      if( (Row[i].text != NULL) && (Row[i].row >= first) && (Row[i].row <= last) )
+	Discard( i );
+    if( AppWindow != NULL )
+      SendMessage( AppWindow, LVM_REDRAWITEMS, first, last );
+  }
+
+  long VirtualListWindow::OnReflectedNotify( NMHDR *hdr )
+  {
+    /* Handle notifications from the list view control, as reflected
+     * back to us by its parent window.
+     */
+    switch( hdr->code )
+    {
+      case LVN_GETDISPINFO:
+	/* The control requires the text for a cell; copy it from the
+	 * cache, (it may not remain there long enough to be referenced
+	 * in place).
+	 */
+	{ LVITEM *item = &((NMLVDISPINFO *)(hdr))->item;
+	  if( (item->mask & LVIF_TEXT) && (item->cchTextMax > 0) )
+	  {
+	    VirtualListRow *row = Fetch( item->iItem );
+	    const char *text = row ? row->text : "";
+	    for( int column = 0; row && (column < item->iSubItem); column++ )
+	      text += strlen( text ) + 1;
+	    strncpy( item->pszText, text, item->cchTextMax );
+	    item->pszText[item->cchTextMax - 1] = '\0';
+	  }
+	}
+	return 0L;
+
+      case LVN_ODCACHEHINT:
+	/* The control is about to request a range of rows; prefetch
+	 * them, (but no more than the cache can accommodate).
+	 */
+	{ NMLVCACHEHINT *hint = (NMLVCACHEHINT *)(hdr);
+	  unsigned long row = hint->iFrom, last = hint->iTo;
+	  if( (last - row) >= CacheSize ) last = row + CacheSize - 1;
+	  while( row <= last ) Fetch( row++ );
+	}
+	return 0L;
+
+      case LVN_ODFINDITEM:
+	return OnFindItem( hdr );
+    }
+    return OnListNotify( hdr );
+  }
+
+  VirtualListWindow::~VirtualListWindow()
+  {
+    /* Release all cached rows, and the cache itself.
+     */
+    for( unsigned int i = 0; i < CacheSize; i++ ) free( (void *)(Row[i].text) );
+    free( (void *)(Row) ); free( (void *)(Bucket) );
+  }
+}
+
+/* $RCSfile$: end of file */
@@ -13,7 +13,7 @@
  * C++ class framework.
  *
  * Written by Keith Marshall <keithmarshall@users.sourceforge.net>
- * Copyright (C) 2012, 2013, MinGW.org Project.
+ * Copyright (C) 2012, 2013, 2026, MinGW.org Project.
  *
  * ---------------------------------------------------------------------------
  *
@@ -44,7 +44,10 @@
 #include <stdlib.h>
 #include <windows.h>
 #include "wtkexcept.h"
+#include "wtkprof.h"
 #include "wtkdefs.h"
+#include "wtkpixel.h"
+#include "wtkdlgtpl.h"
 
 /* This header file is primarily intended to be used only for C++.  However,
  * configure scripts may try to compile it as C, when checking availability;
@@ -55,6 +58,41 @@
 
 namespace WTK
 {
+  /* The number of times a SpinLock contender will yield, by Sleep(0),
+   * before it resorts to Sleep(1).
+   */
+# define WTK_SPINLOCK_YIELDS  16
+
+  class SpinLock
+  {
+    /* A minimal lock, for process wide data which may be shared by more
+     * than one user interface thread; it is held for the lifetime of the
+     * SpinLock object, which should be brief, (and must never span a call
+     * which draws, or waits).  Since the lock itself is a plain LONG, it
+     * needs no run time initialisation, and so may protect static data
+     * which is used during static construction.  It is not recursive.
+     * Sleep(0) yields only to threads of equal, or higher, priority, so a
+     * persistent contender falls back to Sleep(1), allowing a holder of
+     * lower priority to run, and release the lock.
+     */
+    public:
+      SpinLock( volatile LONG *lock ): Lock( lock )
+      {
+	for( int spin = 0; InterlockedExchange( Lock, 1 ) != 0; spin++ )
+	  Sleep( (spin < WTK_SPINLOCK_YIELDS) ? 0 : 1 );
+      }
+      ~SpinLock(){ InterlockedExchange( Lock, 0 ); }
+
+    private:
+      volatile LONG *Lock;
+  };
+
+  /* MSDN says that the maximum length of any one string resource
+   * is 4097 characters; it isn't clear if this limit includes the
+   * terminating NUL, so we'll assume we may need one more.
+   */
+# define WTK_STRING_RESOURCE_MAX  4098
+
   class StringResource
   {
     /* A utility class to facilitate retrieval of string data
@@ -72,6 +110,70 @@ namespace WTK
       const char *value;
   };
 
+  /* Resource types which may be listed in a ResourcePrefetcher manifest;
+   * WTK_PREFETCH_SYSTEM may be combined, (by bit-wise OR), with the icon,
+   * cursor or bitmap type, to designate a predefined system resource, such
+   * as IDC_ARROW, rather than one from the application's own module.
+   */
+# define WTK_PREFETCH_ICON	1
+# define WTK_PREFETCH_CURSOR	2
+# define WTK_PREFETCH_BITMAP	3
+# define WTK_PREFETCH_STRING	4
+# define WTK_PREFETCH_SYSTEM	0x0100
+
+  struct ResourceManifest
+  {
+    /* Each manifest entry identifies one resource, by type and
+     * numeric resource ID.
+     */
+    unsigned int type;
+    unsigned int id;
+  };
+
+  class ResourcePrefetcher
+  {
+    /* A utility class to load a manifest of icon, cursor, bitmap and
+     * string resources in parallel, on worker threads, while the user
+     * interface thread proceeds with other start-up activities.  While
+     * a ResourcePrefetcher object exists, the static methods below will
+     * retrieve resources from its cache, (or load them immediately, if
+     * not yet prefetched); the framework itself uses these in place of
+     * LoadIcon(), LoadCursor() and LoadString().  Only one prefetcher
+     * may be active at any time, and it must not be destroyed while any
+     * other thread may still be calling these methods.
+     */
+    public:
+      ResourcePrefetcher
+      ( HINSTANCE, const ResourceManifest *, unsigned int, unsigned int = 0 );
+      ~ResourcePrefetcher();
+
+      static HICON Icon( HINSTANCE, const char * );
+      static HCURSOR Cursor( HINSTANCE, const char * );
+      /* A string remains owned by the cache; the pointer returned is
+       * valid only until the prefetcher is destroyed, so any caller which
+       * needs the string for longer, (or which may be running concurrently
+       * with that destruction), must copy it, as StringResource does.
+       */
+      static const char *String( HINSTANCE, unsigned int );
+
+      /* Ownership of a bitmap passes to the caller; it is retrieved
+       * from the cache only once, and must eventually be deleted.
+       */
+      static HBITMAP Bitmap( HINSTANCE, const char * );
+
+    private:
+      HINSTANCE Module;
+      struct PrefetchEntry *Entry;
+      unsigned int TableSize, ThreadCount;
+      volatile LONG NextEntry;
+      HANDLE *Thread;
+
+      static ResourcePrefetcher * volatile Active;
+      static unsigned __stdcall Worker( void * );
+      static struct PrefetchEntry *Lookup( unsigned int, HINSTANCE, const char * );
+      void Resolve( struct PrefetchEntry * );
+  };
+
   class GenericDialogue
   {
     /* A simple class to facilitate display of a dialogue box,
@@ -83,8 +185,145 @@ namespace WTK
      */
     public:
       GenericDialogue( HINSTANCE app, HWND parent, int ID )
-      { DialogBox( app, MAKEINTRESOURCE( ID ), parent, Dismiss ); }
+      { LPCDLGTEMPLATE dlg = Template( app, ID );
+	if( dlg != NULL ) DialogBoxIndirectParam( app, dlg, parent, Dismiss, 0 );
+      }
       static BOOL CALLBACK Dismiss( HWND, unsigned, WPARAM, LPARAM );
+
+      /* Dialogue templates are located, in the module's resources,
+       * on first use only; thereafter, they are retrieved from a cache,
+       * to which in-memory templates may also be added.
+       */
+      static LPCDLGTEMPLATE Template( HINSTANCE, int );
+      static void RegisterTemplate( HINSTANCE, int, LPCDLGTEMPLATE );
+  };
+
+  class ModelessDialogue
+  {
+    /* A base class for dialogue boxes which do not block the main
+     * window's message loop; messages are routed to them through the
+     * IsDialogMessage() function, within MainWindowMaker::Invoked().
+     * Once closed, a dialogue may be reopened, from the same template,
+     * by calling Create() again; while it remains open, Create() simply
+     * activates the existing dialogue.  Derived classes may override the
+     * Controller() method, or any of the individual message handlers.
+     */
+    public:
+      ModelessDialogue( HINSTANCE app ): AppInstance( app ), AppDialogue( NULL ){}
+
+      /* A dialogue which remains open when its object is destroyed is
+       * dissociated from the object, and then destroyed, without further
+       * reference to it, since the overrides of a derived class are then
+       * no longer reachable; derived class cleanup belongs in OnDestroy(),
+       * which is called when the dialogue is closed, (by Close(), or by the
+       * user), while the object remains intact.
+       */
+      virtual ~ModelessDialogue(){ Destroy( true ); }
+
+      HWND Create( HWND, int );
+      HWND Handle(){ return AppDialogue; }
+      bool IsOpen(){ return AppDialogue != NULL; }
+      virtual void Close(){ Destroy( false ); }
+
+      /* Route a message to any open modeless dialogue to which it
+       * belongs; this returns true, if the message has been handled.
+       */
+      static bool Dispatch( MSG * );
+
+    protected:
+      HINSTANCE AppInstance;
+      HWND AppDialogue;
+      static BOOL CALLBACK DialogueProcedure( HWND, unsigned, WPARAM, LPARAM );
+      virtual BOOL Controller( unsigned, WPARAM, LPARAM );
+
+    private:
+      virtual BOOL OnInitDialogue();
+      virtual BOOL OnCommand( WPARAM );
+      virtual void OnDestroy(){}
+
+      void Destroy( bool );
+      void Detach();
+
+      /* All open modeless dialogues are linked into a list, which is
+       * traversed by Dispatch(); there is one such list for each thread,
+       * since a message loop may dispatch only to its own thread's windows.
+       */
+      ModelessDialogue *Next;
+      static __thread ModelessDialogue *OpenDialogues;
+  };
+
+  /* A wildcard notification code, which may be used when routing,
+   * or reflecting, notifications to match any code from a specified
+   * control; specific codes take precedence over the wildcard.
+   */
+# define WTK_NOTIFY_ANY  0U
+
+  class DisplayList
+  {
+    /* A retained record of drawing commands, each stored in a compact
+     * buffer with its bounding rectangle, so that any part of a window may
+     * be repainted by replaying only those commands which intersect it.
+     * Colours, pens and fonts are specified by attribute, or by handle, and
+     * are realised through the GdiCache and TextCache on replay; text is
+     * drawn with transparent background, and top left alignment.
+     */
+    public:
+      DisplayList();
+      ~DisplayList();
+
+      void Clear();
+      void Fill( const RECT *, COLORREF );
+      void Frame( const RECT *, COLORREF, int = 1 );
+      void Line( int, int, int, int, COLORREF, int = 1 );
+      void Text( int, int, const char *, COLORREF, HFONT, int = -1 );
+
+      void Replay( HDC, const RECT *, HRGN = NULL );
+      unsigned int Commands(){ return CommandCount; }
+
+    private:
+      char *Buffer;
+      size_t Used, Size;
+      unsigned int CommandCount;
+      HDC Measure;
+
+      void *Append( int, size_t, const RECT * );
+  };
+
+  /* Messages relating to DPI changes, which may not be defined by older
+   * versions of the system headers.
+   */
+# ifndef WM_DPICHANGED
+# define WM_DPICHANGED			0x02E0
+# define WM_DPICHANGED_AFTERPARENT	0x02E3
+# endif
+
+  class DpiScale
+  {
+    /* A collection of static helpers to support per-monitor DPI awareness;
+     * Enable() requests per-monitor (v2) awareness, (if supported by the
+     * running version of Windows), for the process.  This is an election
+     * for the application to make, (by calling Enable() before it creates
+     * its first window, or by declaring awareness in its manifest), since
+     * an aware application must then scale its own layout, fonts, and any
+     * fixed dimensions; (the framework's own controls do so, by means of
+     * Scaled(), and SashWindowMaker::Place()).  The DPI for each monitor is cached, since it is frequently required,
+     * (e.g. for every layout computation), but rarely changes; Forget() must
+     * be called, whenever a change is notified.  Scale() converts a design
+     * dimension, (i.e. in pixels, at 96 DPI), to pixels at a specified DPI.
+     */
+    public:
+      static bool Enable();
+      static UINT ForMonitor( HMONITOR );
+      static UINT ForWindow( HWND );
+      static void Forget();
+      static inline int Scale( int value, UINT dpi )
+      { return MulDiv( value, dpi, USER_DEFAULT_SCREEN_DPI ); }
+
+    private:
+#     define WTK_DPI_MONITORS_MAX  16
+      static HMONITOR Monitor[WTK_DPI_MONITORS_MAX];
+      static UINT MonitorDpi[WTK_DPI_MONITORS_MAX];
+      static unsigned int MonitorCount;
   };
 
   class GenericWindow
@@ -97,16 +336,56 @@ namespace WTK
     protected:
       HWND AppWindow;
       HINSTANCE AppInstance;
-      GenericWindow( HINSTANCE appid ): AppInstance( appid ){}
+      GenericWindow( HINSTANCE appid ): AppWindow( NULL ), AppInstance( appid ),
+	Notifications( NULL ), Display( NULL ), DisplayDirty( false ), WindowDpi( 0 ){}
       static long CALLBACK WindowProcedure( HWND, unsigned, WPARAM, LPARAM );
       virtual long Controller( unsigned, WPARAM, LPARAM );
 
+      /* A window may elect to retain its drawing commands, in a display
+       * list, in which case it should implement OnRecord(), rather than
+       * OnPaint(); its content is recorded on the first WM_PAINT, following
+       * construction, or any call to InvalidateDisplay(), and each WM_PAINT
+       * replays only those commands which intersect the update region.
+       */
+      void RetainDisplay( bool = true );
+      void InvalidateDisplay();
+
+      /* The DPI of the monitor on which the window is displayed, and a
+       * helper to scale a design dimension to suit it; (the value is cached,
+       * once the window exists, and updated on receipt of any WM_DPICHANGED
+       * message; before then, the DPI of the primary monitor is returned).
+       */
+      UINT Dpi();
+      int Scaled( int value ){ return DpiScale::Scale( value, Dpi() ); }
+
     public:
+      virtual ~GenericWindow(){ delete Display; free( (void *)(Notifications) ); }
+
       /* This hook is provided to facilitate the implementation of
        * sash window controls, (not standard in MS-Windows-API).
        */
       virtual long AdjustLayout(){ return 1L; }
 
+      /* WM_NOTIFY messages may be routed directly to individual member
+       * handlers, each selected by control ID and notification code, in
+       * preference to the catch-all OnNotify() handler; the value which
+       * is returned by the handler becomes the result of the message.
+       * Alternatively, they may be reflected back to the OnReflectedNotify()
+       * method of the window object which represents the originating
+       * control itself, (identified by a pointer to that object, once its
+       * control has been created); they are reflected only while they
+       * originate from that same control window.
+       */
+      typedef long (GenericWindow::*NotificationHandler)( NMHDR * );
+      void RouteNotification( unsigned int, unsigned int, NotificationHandler );
+      void ReflectNotification( GenericWindow *, unsigned int = WTK_NOTIFY_ANY );
+      virtual long OnReflectedNotify( NMHDR * ){ return 0L; }
+
+    private:
+      struct NotificationMap *Notifications;
+      void MapNotification( unsigned int, unsigned int, NotificationHandler, GenericWindow * );
+      long DispatchNotification( WPARAM, LPARAM );
+
     private:
       /* The following (incomplete) list identifies the windows
        * messages which this framework can currently handle, and
@@ -128,11 +407,254 @@ namespace WTK
       virtual long OnVerticalScroll( int, int, HWND ){ return 1L; }
       virtual long OnNotify( WPARAM, LPARAM ){ return 1L; }
       virtual long OnPaint(){ return 1L; }
+      virtual void OnRecord( DisplayList * ){}
       virtual long OnLeftButtonDown(){ return 1L; }
       virtual long OnLeftButtonUp(){ return 1L; }
       virtual long OnMouseMove( WPARAM ){ return 1L; }
+      virtual long OnMouseWheel( WPARAM ){ return 1L; }
+      virtual long OnTimer( WPARAM ){ return 1L; }
+      virtual void OnDpiChanged( UINT ){}
       virtual long OnDestroy(){ return 0L; }
       virtual long OnClose(){ return 1L; }
+
+      /* Helpers, to dispatch OnPaint() with start-up profiling, and to
+       * paint from a retained display list.
+       */
+      long ProfiledPaint();
+      long Paint();
+
+      /* Helper to handle a change of DPI, notifying OnDpiChanged(), then
+       * adopting the suggested window rectangle, (if any), and ensuring that
+       * the layout is adjusted exactly once.
+       */
+      long DpiChanged( UINT, const RECT * );
+
+      DisplayList *Display;
+      bool DisplayDirty;
+      UINT WindowDpi;
+  };
+
+  /* The default number of unreferenced objects which a GdiCache will
+   * retain, for possible reuse, before deleting the least recently used.
+   */
+# define WTK_GDICACHE_RETAIN  64
+
+  class GdiCache
+  {
+    /* A process wide cache of shared GDI brushes, pens and fonts, each
+     * identified by the attributes from which it was created; requests for
+     * an object with the same attributes as one already cached return that
+     * same object, with its reference count incremented.  Each reference
+     * must eventually be returned by Release(); unreferenced objects are
+     * retained, up to a configurable limit, (beyond which the least recently
+     * released are deleted), so that objects which are repeatedly acquired
+     * and released, during painting, need not be repeatedly recreated.
+     * Callers must never delete any object obtained from the cache.
+     */
+    public:
+      static HBRUSH Brush( COLORREF );
+      static HPEN Pen( COLORREF, int = 1, int = PS_SOLID );
+      static HFONT Font( const LOGFONT * );
+      static void Release( HGDIOBJ );
+
+      static void SetCapacity( unsigned int );
+      static void Purge();
+
+      /* Cache statistics, and the number of GDI objects currently owned
+       * by the process, (from all sources, not only this cache).
+       */
+      static unsigned long Hits(){ return HitCount; }
+      static unsigned long Misses(){ return MissCount; }
+      static unsigned int Objects(){ return ObjectCount; }
+      static DWORD HandleCount();
+
+    private:
+      static struct GdiCacheEntry *Bucket[], *Handle[], *Newest, *Oldest;
+      static unsigned int Capacity, ObjectCount, IdleCount;
+      static unsigned long HitCount, MissCount;
+
+      static HGDIOBJ Acquire( int, const void *, size_t );
+      static void Unlink( struct GdiCacheEntry * );
+      static void Delete( struct GdiCacheEntry * );
+      static void Trim( unsigned int );
+  };
+
+  class ScaledFont
+  {
+    /* A font, specified by its design attributes at 96 DPI, and realised
+     * through the GdiCache, at the size appropriate to any specified DPI;
+     * it is rebuilt only when the specified DPI actually changes.
+     */
+    public:
+      ScaledFont( const LOGFONT *design ): Design( *design ), Font( NULL ), FontDpi( 0 ){}
+      ~ScaledFont(){ if( Font != NULL ) GdiCache::Release( Font ); }
+      HFONT For( UINT );
+
+    private:
+      LOGFONT Design;
+      HFONT Font;
+      UINT FontDpi;
+
+      /* The object owns a GdiCache reference to its font, so copying is
+       * prohibited; (these are declared, but never implemented).
+       */
+      ScaledFont( const ScaledFont & );
+      ScaledFont &operator=( const ScaledFont & );
+  };
+
+  /* The default number of distinct (font, string) pairs which will be
+   * retained by the TextCache.
+   */
+# define WTK_TEXTCACHE_ENTRIES  1024
+
+  class TextCache
+  {
+    /* A process wide cache of text measurements, and of shaped glyph
+     * runs, each keyed by font handle and string content, with the least
+     * recently used entries being evicted when the cache is full.  Extent()
+     * is a substitute for GetTextExtentPoint32(), and Draw() for ExtTextOut(),
+     * each using the font which is currently selected into the specified
+     * device context; (measurements are assumed to be in the MM_TEXT mapping
+     * mode).  Since font handles may be reused, after the font is deleted,
+     * the owner of any font must call Forget(), before deleting it; (the
+     * GdiCache does so, for its own fonts).
+     */
+    public:
+      static SIZE Extent( HDC, const char *, int = -1 );
+      static BOOL Draw( HDC, int, int, const char *, int = -1, UINT = 0, const RECT * = NULL );
+
+      static void Forget( HFONT );
+      static void SetCapacity( unsigned int );
+      static void Purge();
+
+      /* Cache statistics.
+       */
+      static unsigned long Hits(){ return HitCount; }
+      static unsigned long Misses(){ return MissCount; }
+
+    private:
+      static struct TextCacheEntry *Bucket[], *Newest, *Oldest;
+      static unsigned int Capacity, EntryCount;
+      static unsigned long HitCount, MissCount;
+
+      static struct TextCacheEntry *Lookup( HDC, const char *, int, bool = true );
+      static void Delete( struct TextCacheEntry * );
+      static void Trim( unsigned int );
+  };
+
+  class Canvas
+  {
+    /* An off-screen drawing surface, comprising a top-down 32-bpp DIB
+     * section, selected into a memory device context, which may be drawn
+     * directly, by the pixel kernels of wtkpixel.h, (or by GDI, through its
+     * device context), and then presented to a window, typically within its
+     * OnPaint() handler, by a single BitBlt() of the invalidated region.
+     * Pixels are premultiplied 0xAARRGGBB values; colours are specified as
+     * COLORREF values, with a separate, straight, alpha value.
+     */
+    public:
+      Canvas();
+      ~Canvas();
+
+      void Resize( int, int );
+      inline int Width(){ return CanvasWidth; }
+      inline int Height(){ return CanvasHeight; }
+      inline HDC DC(){ return Surface; }
+      inline uint32_t *Row( int y ){ return Pixels + (size_t)(y) * CanvasWidth; }
+
+      void Fill( const RECT *, COLORREF, BYTE = 255 );
+      void Gradient( const RECT *, COLORREF, COLORREF, bool = false );
+      void RoundRect( const RECT *, int, COLORREF, BYTE = 255 );
+      void Blend( int, int, const uint32_t *, int, int, int );
+
+      void Present( HDC, const RECT * = NULL, int = 0, int = 0 );
+
+    private:
+      HDC Surface;
+      HBITMAP Bitmap, Original;
+      uint32_t *Pixels;
+      uint8_t *Coverage;
+      int CanvasWidth, CanvasHeight;
+
+      bool Clip( const RECT *, RECT * );
+  };
+
+  /* The dimensions of each IconAtlas page, and the default limit on the
+   * total memory which may be committed to all pages of any one atlas.
+   */
+# define WTK_ATLAS_PAGE  256
+# define WTK_ATLAS_MEMORY_LIMIT  0x00400000UL
+
+  class IconAtlas
+  {
+    /* A store of small images, (icons, or bitmaps), packed into a few
+     * large 32-bpp DIB section pages, so that each may be drawn by a single
+     * AlphaBlend() operation, from one shared memory device context, (or
+     * directly onto a Canvas), without holding a GDI object per image.
+     * Request() returns an image index immediately, but images are decoded
+     * asynchronously, on worker threads; on completion of any decode, the
+     * nominated message is posted to the nominated window, (with a WPARAM
+     * of zero), whereupon the user interface thread should call Collect(),
+     * to pack the decoded images into the atlas pages, and repaint.  Images
+     * which are not yet available are simply not drawn.  Pages are packed
+     * by a skyline algorithm, and new pages are added on demand, up to a
+     * specified memory limit, beyond which further requests will fail.
+     * (Applications using this class must link with libmsimg32).
+     */
+    public:
+      IconAtlas( int = 16, size_t = WTK_ATLAS_MEMORY_LIMIT, unsigned int = 0 );
+      ~IconAtlas();
+
+      void Attach( HWND, unsigned int );
+
+      /* Images are identified by module and resource name, (or by file
+       * name, when the module is NULL), and by type, which may be either
+       * WTK_PREFETCH_ICON, (loaded at the size of the atlas), or else
+       * WTK_PREFETCH_BITMAP, (loaded at natural size, and drawn opaque);
+       * repeated requests for the same image return the same index.
+       */
+      int Request( HINSTANCE, const char *, unsigned int = WTK_PREFETCH_ICON );
+      unsigned int Collect();
+
+      bool Ready( int );
+      bool Draw( HDC, int, int, int );
+      bool Draw( Canvas *, int, int, int );
+
+      /* Atlas statistics: the number of pages allocated, the memory they
+       * occupy, the fraction of their area filled by images, and the number
+       * of requests which remain to be decoded, or which have failed.
+       */
+      unsigned int Pages(){ return PageCount; }
+      size_t Memory(){ return (size_t)(PageCount) * WTK_ATLAS_PAGE * WTK_ATLAS_PAGE * 4; }
+      double Occupancy();
+      unsigned int Pending(){ return PendingCount; }
+      unsigned int Failures(){ return FailureCount; }
+
+    private:
+      int IconSize;
+      size_t MemoryLimit;
+      HWND Window; unsigned int Message;
+
+      struct AtlasEntry *Entry;
+      unsigned int EntryCount, EntrySize, *Index, IndexMask;
+      unsigned int PendingCount, FailureCount;
+      unsigned long PackedArea;
+
+      struct AtlasPage *Page;
+      unsigned int PageCount;
+      HDC Surface; HBITMAP Original; int Selected;
+
+      CRITICAL_SECTION Lock;
+      struct AtlasJob *Queue, *QueueTail, * volatile Completed;
+      HANDLE Work, *Thread;
+      unsigned int ThreadCount;
+      volatile LONG Stopping;
+
+      static unsigned __stdcall Worker( void * );
+      static uint32_t *Decode( struct AtlasJob * );
+      bool Pack( int, int, int *, int *, int * );
+      void Store( struct AtlasJob * );
+      void Rehash();
   };
 
   class WindowClassMaker: protected WNDCLASS, protected GenericWindow
@@ -180,10 +702,19 @@ namespace WTK
 	 */
 	hbrBackground = colour;
       }
+      inline void SetBackground( COLORREF colour )
+      {
+	/* Alternatively, set it from an RGB colour specification,
+	 * using a brush from the shared cache, (which is retained
+	 * for the lifetime of the process).
+	 */
+	hbrBackground = GdiCache::Brush( colour );
+      }
       inline int Register( const char *ClassName )
       {
 	/* Register the named window class...
 	 */
+	StartupPhase phase( "RegisterClass" );
 	lpszClassName = ClassName;
 	if( int retval = RegisterClass( this ) ) return retval;
 
@@ -205,29 +736,563 @@ namespace WTK
       int Update(){ return UpdateWindow( AppWindow ); }
   };
 
+  class EventMonitor
+  {
+    /* An abstract base class, from which classes may be derived when
+     * their objects are to be notified, from within the message loop
+     * of a MainWindowMaker object, (see Invoked() below), whenever an
+     * associated kernel object, (event, waitable timer, etc.), becomes
+     * signalled; the OnSignalled() method is invoked on the thread
+     * which is running the message loop.
+     */
+    public:
+      virtual HANDLE EventHandle() = 0;
+      virtual void OnSignalled() = 0;
+  };
+
+  class MessageLanes
+  {
+    /* A framework level queue for application defined messages, which
+     * are posted, (from any thread), to one of several priority lanes,
+     * rather than to the single FIFO queue of the Windows message loop.
+     * A single registered wake message is posted, to the attached window,
+     * whenever work becomes pending; its handler drains the lanes by
+     * weighted round robin, (so that bulk notifications are delayed by,
+     * but never starved by, those of higher priority), yielding whenever
+     * genuine user input, or painting, is waiting to be processed.  Items
+     * are delivered, on the user interface thread, by SendMessage().
+     */
+    public:
+#     define WTK_LANE_INPUT	0
+#     define WTK_LANE_NORMAL	1
+#     define WTK_LANE_BULK	2
+#     define WTK_LANES		3
+
+#     define WTK_LANE_SLICE	8
+#     define WTK_LANE_TIMER_ID	0x574C
+
+      MessageLanes();
+      ~MessageLanes();
+
+      /* Post() may be called from any thread; a NULL target window
+       * designates the attached window.  It returns false, if the lane
+       * is invalid, or if no memory is available to queue the item.
+       */
+      bool Post( unsigned int, HWND, UINT, WPARAM = 0, LPARAM = 0 );
+
+      /* Methods for use by the user interface thread: Attach() nominates
+       * the window which is to receive the wake message, (usually by way
+       * of MainWindowMaker::AttachLanes()), and Handle() should be invoked
+       * by its Controller(), for every message; it returns true, if the
+       * message was consumed in servicing the lanes.  The weight of a lane
+       * is the number of its items served in each round; (defaults are 8,
+       * 3 and 1, for input critical, normal and bulk lanes respectively).
+       */
+      void Attach( HWND );
+      bool Handle( unsigned, WPARAM );
+      void SetWeight( unsigned int, unsigned int );
+      unsigned int Drain();
+
+      /* Statistics, per lane: the number of items currently queued, the
+       * number served, and the mean and maximum time, in milliseconds, for
+       * which served items were queued; Yields() counts the occasions on
+       * which draining was suspended, in deference to pending input.
+       */
+      LONG Depth( unsigned int lane ){ return Lane[lane].depth; }
+      unsigned long Served( unsigned int lane ){ return Lane[lane].served; }
+      double MeanWait( unsigned int );
+      double MaxWait( unsigned int );
+      unsigned long Yields(){ return YieldCount; }
+      void ResetStatistics();
+
+    private:
+      struct LaneItem
+      {
+	LaneItem *next; HWND window; UINT message;
+	WPARAM w_param; LPARAM l_param; LONGLONG posted;
+      };
+      struct LaneState
+      {
+	LaneItem *head, *tail; volatile LONG depth; unsigned int weight;
+	unsigned long served; LONGLONG total_wait, max_wait;
+      } Lane[WTK_LANES];
+
+      CRITICAL_SECTION Lock;
+      HWND volatile Window; UINT WakeMessage; volatile LONG Signalled;
+      LONGLONG Frequency; unsigned long YieldCount;
+
+      LaneItem *Take( unsigned int );
+      void Wake();
+  };
+
   class MainWindowMaker: public WindowMaker
   {
     /* A stock window class, suitable for providing the implementation
-     * of an application's main window.
+     * of an application's main window, or of the principal window of any
+     * UIThread; its message loop serves only the windows, dialogues and
+     * monitors of the thread on which Invoked() is called.
      */
     public:
-      MainWindowMaker( HINSTANCE instance ): WindowMaker( instance ){}
+      MainWindowMaker( HINSTANCE instance ): WindowMaker( instance ),
+	MonitorCount( 0 ), NextMonitor( 0 ), Lanes( NULL ){}
       virtual int Invoked();
 
+      /* Methods to attach EventMonitor objects to, and to detach them
+       * from, the message loop; no more than WTK_MONITORS_MAX may be
+       * attached at any one time.
+       */
+      void AttachMonitor( EventMonitor * );
+      void DetachMonitor( EventMonitor * );
+
+      /* Method to attach a set of MessageLanes, (or NULL, to detach any
+       * which were previously attached), which will then be serviced
+       * whenever this window's message loop is running.
+       */
+      void AttachLanes( MessageLanes * );
+
+    protected:
+      virtual long Controller( unsigned, WPARAM, LPARAM );
+
     private:
       virtual long OnDestroy();
+
+#     define WTK_MONITORS_MAX  (MAXIMUM_WAIT_OBJECTS - 1)
+      EventMonitor *Monitor[WTK_MONITORS_MAX];
+      unsigned MonitorCount, NextMonitor;
+      MessageLanes *Lanes;
+  };
+
+  class UIThread
+  {
+    /* A base class for secondary user interface threads, each of which
+     * owns its own top level windows, and runs its own message loop, so that
+     * a window which is slow to process its messages, (e.g. a log viewer),
+     * can never stall input handling in the windows of any other thread.
+     * Derived classes implement Run(), which is invoked on the new thread;
+     * it should create the thread's windows, (typically derived from the
+     * MainWindowMaker class), and return the result of Invoked().  Since
+     * PostQuitMessage() affects only the calling thread, destroying such a
+     * window ends only its own thread's loop; the application's primary
+     * thread should Stop() all others, before it exits.  Run() must not
+     * allow any exception to escape.
+     */
+    public:
+      UIThread(): Thread( NULL ), ThreadId( 0 ), ExitCode( 0 ){}
+      virtual ~UIThread();
+
+      /* Start() returns only when the new thread's message queue exists,
+       * so that a Quit() request, issued at any time thereafter, cannot be
+       * lost; Wait() returns true, if the thread has finished, or had never
+       * been started, and Stop() combines Quit() and Wait().  A derived class
+       * should call Stop() in its own destructor, if its Run() method uses
+       * any of its own data members.
+       */
+      void Start();
+      void Quit( int = EXIT_SUCCESS );
+      bool Wait( DWORD = INFINITE );
+      void Stop(){ Quit(); Wait(); }
+
+      bool IsRunning(){ return ! Wait( 0 ); }
+      DWORD Id(){ return ThreadId; }
+      int ExitStatus(){ return ExitCode; }
+
+    protected:
+      virtual int Run() = 0;
+
+    private:
+      static unsigned __stdcall Entry( void * );
+      HANDLE Thread, Ready;
+      unsigned ThreadId;
+      volatile int ExitCode;
+  };
+
+  class SingleInstance: public EventMonitor
+  {
+    /* A helper class to facilitate detection of any already running
+     * instance of an application, (identified by a unique name), and
+     * to forward the command line of any subsequently started instance
+     * to it, via a shared memory region; this avoids any need to look
+     * up the main window of the running instance, by class name.
+     */
+    public:
+      SingleInstance( const char * );
+      ~SingleInstance(){ Release(); }
+
+      /* In the first running instance, IsPrimary() returns true; it
+       * should then Attach() its main window, so that forwarded requests
+       * may be delivered to OnForwardedRequest(), within its message loop.
+       * In any other instance, IsPrimary() returns false; it should then
+       * Forward() its arguments to the primary instance, and exit.
+       */
+      bool IsPrimary(){ return Primary; }
+      void Attach( MainWindowMaker *, HWND );
+      bool Forward( const char * = GetCommandLine() );
+
+      HANDLE EventHandle(){ return Request; }
+      void OnSignalled();
+
+    protected:
+      /* Derived classes override this, to handle the command line
+       * which has been forwarded from another instance; it is passed
+       * by reference to the shared memory region itself, so it must
+       * be copied, if it is required after returning.
+       */
+      virtual void OnForwardedRequest( const char * ){}
+
+    private:
+      void Release();
+      bool Primary;
+      HANDLE Mutex, Mapping, Request;
+      struct SharedRequest *Shared;
+      MainWindowMaker *Owner;
   };
 
   class ChildWindowMaker: public WindowMaker
   {
     /* A stock window class, suitable for providing the implementation
-     * of a general purpose child window.
+     * of a general purpose child window.  Creation of the window itself
+     * may be deferred, (using Defer() in place of Create()), until such
+     * time as it is first shown, or its handle is first requested; until
+     * then, Place() merely records the layout which is to be applied when
+     * the window is eventually realised.
      */
     public:
-      ChildWindowMaker( HINSTANCE inst ): WindowMaker( inst ){}
+      ChildWindowMaker( HINSTANCE inst ): WindowMaker( inst ),
+	DeferredClassName( NULL ){ Frame.left = Frame.top = Frame.right = Frame.bottom = 0; }
       HWND Create( int, HWND, const char *, unsigned long = 0 );
+      void Defer( int, HWND, const char *, unsigned long = 0 );
+      bool IsRealised( void ){ return AppWindow != NULL; }
+      HWND Handle( void ){ return Realise(); }
+      HWND Realise( void );
+      int Place( int, int, int, int );
+      int Show( int );
+
+    protected:
+      /* Realise() creates a deferred window by way of this method, which
+       * is passed the attributes recorded by Defer(); derived classes whose
+       * own Create() method does more than create the window must override
+       * it, to delegate to that Create() method.
+       */
+      virtual HWND OnRealise( int id, HWND parent, const char *name, unsigned long style )
+      { return Create( id, parent, name, style ); }
+
+    private:
+      /* Attributes recorded by Defer(), for use by Realise(); note
+       * that the class name is NOT copied, so the caller must ensure
+       * that it remains valid until the window has been realised.
+       */
+      int DeferredID;
+      HWND DeferredParent;
+      const char *DeferredClassName;
+      unsigned long DeferredStyle;
+      RECT Frame;
   };
 
+  /* The number of slots in a TimerWheel; this must be a power of two.
+   */
+# define WTK_TIMER_SLOTS  1024
+
+  class Timer
+  {
+    /* An abstract base class for logical timers, which are serviced
+     * by a TimerWheel; derived classes must implement the OnTimer()
+     * method, which is invoked on expiry, (on the thread running the
+     * message loop to which the TimerWheel is attached).  A timer is
+     * cancelled automatically, if destroyed while pending.
+     */
+    public:
+      Timer(): Wheel( NULL ){}
+      virtual ~Timer(){ Cancel(); }
+      bool IsPending(){ return Wheel != NULL; }
+      void Cancel();
+
+    private:
+      virtual void OnTimer() = 0;
+
+      friend class TimerWheel;
+      class TimerWheel *Wheel;
+      Timer *Prev, *Next;
+      unsigned int Slot;
+      ULONGLONG Due, Tick, Interval;
+  };
+
+  class TimerWheel: public EventMonitor
+  {
+    /* A service which multiplexes any number of logical timers onto a
+     * single waitable timer, within the message loop of a MainWindowMaker
+     * object; timers are hashed into the slots of a wheel, by expiry time,
+     * (so both scheduling and cancellation are constant time operations),
+     * and all timers which expire within the same tick of the wheel are
+     * coalesced, and dispatched together.  The wheel's clock is set to
+     * signal only at the earliest tick for which any timer is due, so no
+     * time is consumed while waiting, however distant that tick may be.
+     */
+    public:
+      TimerWheel( unsigned int = 10 );
+      ~TimerWheel();
+      void Attach( MainWindowMaker * );
+
+      /* Schedule a timer to expire after a specified delay, and then,
+       * if a period is specified, repeatedly at that interval; both are
+       * in milliseconds.  Rescheduling a pending timer is permitted.
+       */
+      void Schedule( Timer *, unsigned long, unsigned long = 0 );
+      void Cancel( Timer *timer ){ if( timer->Wheel == this ) Unlink( timer ); }
+
+      HANDLE EventHandle(){ return Clock; }
+      void OnSignalled();
+
+      /* Statistics: the number of pending timers, and the number of
+       * expiries dispatched, with their mean and maximum lateness, in
+       * milliseconds, relative to their nominal expiry times.
+       */
+      unsigned long Pending(){ return PendingCount; }
+      unsigned long Dispatched(){ return DispatchCount; }
+      double MeanDrift(){ return DispatchCount ? (double)(TotalDrift) / DispatchCount : 0.0; }
+      unsigned long MaxDrift(){ return PeakDrift; }
+      void ResetStatistics(){ DispatchCount = PeakDrift = 0; TotalDrift = 0; }
+
+    private:
+      HANDLE Clock;
+      MainWindowMaker *Owner;
+      unsigned int Resolution;
+      ULONGLONG Origin, Frequency, CurrentTick, ArmedTick;
+      Timer *Slot[WTK_TIMER_SLOTS + 1];
+      unsigned long PendingCount, DispatchCount, PeakDrift;
+      ULONGLONG TotalDrift;
+
+      ULONGLONG Now();
+      void Insert( Timer *, unsigned int );
+      void Remove( Timer * );
+      void Link( Timer * );
+      void Unlink( Timer * );
+      void Arm( ULONGLONG );
+      ULONGLONG Earliest();
+  };
+
+  class Binding
+  {
+    /* An abstract base class for bindings, each of which connects one
+     * observable model field to a control, (or other window), which is to
+     * present it.  When the field changes, the binding is marked dirty, and
+     * the control is updated, by the Apply() method of the derived class, on
+     * the next flush of the BindingSet to which it has been added; (if it
+     * has not been added to any set, it is updated immediately).
+     */
+    public:
+      Binding(): Owner( NULL ), Next( NULL ), Dirty( false ){}
+      virtual ~Binding();
+
+    protected:
+      /* Helpers for use by derived classes: Changed() marks the binding
+       * dirty, Unchanged() records a change notification which has been
+       * discarded, because it repeats the current value, and Applied()
+       * records whether Apply() did update the control.
+       */
+      void Changed();
+      void Unchanged();
+      void Applied( bool );
+      bool IsDirty(){ return Dirty; }
+
+    private:
+      virtual void Apply() = 0;
+
+      friend class BindingSet;
+      class BindingSet *Owner;
+      Binding *Next;
+      bool Dirty;
+  };
+
+  class TextBinding: public Binding
+  {
+    /* A binding of a text field, to the caption of a window, (as set
+     * by ChangeCaption(), i.e. WM_SETTEXT); this serves for labels, edit
+     * controls, status captions, and window titles.
+     */
+    public:
+      TextBinding( HWND window = NULL ): Target( window ), Value( NULL ), Shown( NULL ){}
+      ~TextBinding(){ free( Value ); free( Shown ); }
+
+      void Bind( HWND window ){ Target = window; free( Shown ); Shown = NULL; Changed(); }
+      void Set( const char * );
+      const char *Get(){ return Value ? Value : ""; }
+
+    private:
+      HWND Target;
+      char *Value, *Shown;
+      void Apply();
+  };
+
+  class ValueBinding: public Binding
+  {
+    /* A binding of an integer field, to a control specific setter message,
+     * (e.g. PBM_SETPOS, TBM_SETPOS, BM_SETCHECK, or CB_SETCURSEL), with the
+     * value passed as either its WPARAM, or its LPARAM, (as the message may
+     * require; for the latter, the WPARAM is TRUE, as TBM_SETPOS expects).
+     */
+    public:
+      ValueBinding( HWND window, UINT message, bool in_lparam = false ):
+	Target( window ), Message( message ), InLParam( in_lparam ),
+	Value( 0 ), Shown( 0 ), Valid( false ){}
+
+      void Bind( HWND window ){ Target = window; Valid = false; Changed(); }
+      void Set( long );
+      long Get(){ return Value; }
+
+    private:
+      HWND Target;
+      UINT Message;
+      bool InLParam;
+      long Value, Shown;
+      bool Valid;
+      void Apply();
+  };
+
+  class RowBinding: public Binding
+  {
+    /* A binding of the rows of a model to a VirtualListWindow; changes
+     * to individual rows are accumulated, as a single range, and the rows
+     * within that range are invalidated, together, on the next flush.
+     */
+    public:
+      RowBinding( class VirtualListWindow *list ): List( list ), First( 0 ), Last( 0 ){}
+      void Set( unsigned long row ){ Set( row, row ); }
+      void Set( unsigned long, unsigned long );
+
+    private:
+      class VirtualListWindow *List;
+      unsigned long First, Last;
+      void Apply();
+  };
+
+  class BindingSet: public EventMonitor
+  {
+    /* A collection of bindings, whose pending updates are applied together,
+     * once per frame, within the message loop of a MainWindowMaker object;
+     * the frame clock is a waitable timer, which runs only while at least
+     * one binding is dirty.  A binding which is marked dirty repeatedly,
+     * within one frame, is updated only once, and an update which would not
+     * change the presented value is suppressed.
+     */
+    public:
+      BindingSet( unsigned int = 16 );
+      ~BindingSet();
+      void Attach( MainWindowMaker * );
+
+      void Add( Binding * );
+      void Remove( Binding * );
+      void Flush();
+
+      HANDLE EventHandle(){ return Clock; }
+      void OnSignalled(){ Flush(); }
+
+      /* Statistics: the number of changes notified, (excluding those
+       * which merely repeat the current value), the number coalesced with
+       * an update already pending, the number of updates actually applied,
+       * or suppressed, and the number of frames flushed.
+       */
+      unsigned long Changes(){ return ChangeCount; }
+      unsigned long Coalesced(){ return CoalescedCount; }
+      unsigned long Updates(){ return UpdateCount; }
+      unsigned long Suppressed(){ return SuppressedCount; }
+      unsigned long Frames(){ return FrameCount; }
+
+    private:
+      friend class Binding;
+      HANDLE Clock;
+      MainWindowMaker *Owner;
+      unsigned int Frame;
+      bool Armed;
+      Binding *Head, *Tail, *InFlight, **Member;
+      unsigned int MemberCount, MemberSize;
+      unsigned long ChangeCount, CoalescedCount, UpdateCount, SuppressedCount, FrameCount;
+
+      void Mark( Binding * );
+      bool Unlink( Binding **, Binding **, Binding * );
+  };
+
+  /* The number of status text slots in a ProgressChannel, the capacity
+   * of each, and the range to which progress bars are scaled.
+   */
+# define WTK_PROGRESS_SLOTS	     8
+# define WTK_PROGRESS_TEXT_MAX	   120
+# define WTK_PROGRESS_SCALE	  1000
+
+  class ProgressChannel: private Timer
+  {
+    /* A conduit for progress reports, from any number of worker threads,
+     * to the user interface thread.  Workers update atomic counters, and
+     * status text slots, (each protected by a sequence lock), without ever
+     * blocking on the user interface thread, or posting any message to it;
+     * the user interface thread samples the channel, at a configurable rate,
+     * by a timer on a TimerWheel, and updates the attached progress bar and
+     * caption, only when the visible state has actually changed.  Each status
+     * slot should normally be assigned to a single worker; concurrent writers
+     * to one slot are serialised, but never wait for the reader.  The caption
+     * presents the most recently updated slot.
+     */
+    public:
+      ProgressChannel( unsigned int = 30 );
+
+      /* Methods for use by worker threads.
+       */
+      void SetTotal( LONG total ){ InterlockedExchange( &Total, total ); }
+      void Advance( LONG count = 1 ){ InterlockedExchangeAdd( &Done, count ); }
+      void Status( const char *, unsigned int = 0 );
+
+      /* Methods for use by the user interface thread: Attach() nominates
+       * a progress bar, and a window whose caption is to present status, (or
+       * NULL, for either), then Start() and Stop() control sampling; Stop()
+       * takes a final sample, so that the completed state is presented.
+       */
+      void Attach( HWND, HWND );
+      void Start( TimerWheel * );
+      void Stop();
+      void Reset(){ InterlockedExchange( &Done, 0 ); }
+
+      LONG Completed(){ return Done; }
+      LONG Expected(){ return Total; }
+
+      /* Statistics: the number of samples taken, and the number of those
+       * which resulted in an update to the visible state.
+       */
+      unsigned long Samples(){ return SampleCount; }
+      unsigned long Updates(){ return UpdateCount; }
+
+    protected:
+      /* Derived classes may override this, to present progress in some
+       * other manner; it is invoked for each sample, with the completed
+       * fraction scaled to WTK_PROGRESS_SCALE, and the current status text,
+       * (or NULL, if it has not changed since the previous sample); it must
+       * return true, if the visible state was updated.
+       */
+      virtual bool OnProgress( int, const char * );
+
+    private:
+      volatile LONG Done, Total, Stamp;
+      struct ProgressSlot
+      {
+	volatile LONG sequence, stamp;
+	char text[WTK_PROGRESS_TEXT_MAX];
+      } Slot[WTK_PROGRESS_SLOTS];
+
+      unsigned int Period;
+      LONG ShownStamp;
+      char Sampled[WTK_PROGRESS_TEXT_MAX];
+      ValueBinding Bar;
+      TextBinding Caption;
+      unsigned long SampleCount, UpdateCount;
+
+      void OnTimer();
+  };
+
+  /* Helper macro, to convert a pointer to a notification handling
+   * method of a derived window class, to the form which is required
+   * by GenericWindow::RouteNotification().
+   */
+# define WTK_NOTIFICATION_HANDLER( CLASS, METHOD ) \
+  static_cast<WTK::GenericWindow::NotificationHandler>( &CLASS::METHOD )
+
   inline GenericWindow *WindowObjectReference( HWND window )
   {
     /* A helper function; it returns a pointer to the C++ class
@@ -236,6 +1301,406 @@ namespace WTK
     return (GenericWindow *)(GetWindowLongPtr( window, GWLP_USERDATA ));
   }
 
+  class VirtualListSource
+  {
+    /* An abstract base class, representing the data source for a
+     * VirtualListWindow; derived classes must report the number of rows
+     * available, and must supply the text for any specified cell, (as a
+     * NUL terminated string, truncated to fit the specified buffer size),
+     * on demand.  Row and column indices are zero based.
+     */
+    public:
+      virtual unsigned long RowCount() = 0;
+      virtual void FetchText( unsigned long, int, char *, size_t ) = 0;
+  };
+
+  /* The default number of rows to be held in the row cache of any
+   * VirtualListWindow, and the maximum length of any cell text which
+   * it will retrieve from its VirtualListSource.
+   */
+# define WTK_LIST_CACHE_DEFAULT  256
+# define WTK_LIST_TEXT_MAX	  260
+
+  class VirtualListWindow: public ChildWindowMaker
+  {
+    /* A stock window class, implementing a report style list view
+     * control in owner data mode; no item data is stored in the control
+     * itself, but cell text is retrieved on demand from a data source,
+     * via a cache of recently displayed rows, (with least recently used
+     * rows being evicted, when the cache is full); thus memory usage is
+     * proportional to the number of rows which are visible, irrespective
+     * of the total number of rows available.  The parent window must be
+     * a GenericWindow object, (notifications from the control are reflected
+     * back to this object, by the parent); the application must initialise
+     * the common controls library, before creating any such window.
+     */
+    public:
+      VirtualListWindow( HINSTANCE, VirtualListSource *,
+	  unsigned int = WTK_LIST_CACHE_DEFAULT
+	);
+      ~VirtualListWindow();
+
+      HWND Create( int, HWND, unsigned long = 0 );
+      void Defer( int, HWND, unsigned long = 0 );
+      int AddColumn( const char *, int );
+
+      /* Methods to inform the control of changes in its data source:
+       * Refresh() rereads the row count, and discards all cached rows,
+       * while Invalidate() discards, and redraws, only a specified range.
+       */
+      void Refresh();
+      void Invalidate( unsigned long, unsigned long );
+
+      /* Row cache statistics.
+       */
+      unsigned long CacheHits(){ return Hits; }
+      unsigned long CacheMisses(){ return Misses; }
+
+    protected:
+      long OnReflectedNotify( NMHDR * );
+      HWND OnRealise( int id, HWND parent, const char *, unsigned long style )
+      { return Create( id, parent, style ); }
+
+      /* Overridable handlers for notifications, other than those for
+       * retrieval of display information, or cache hints, which are
+       * handled internally; by default, LVN_ODFINDITEM finds nothing.
+       */
+      virtual long OnFindItem( NMHDR * ){ return -1L; }
+      virtual long OnListNotify( NMHDR * ){ return 0L; }
+
+    private:
+      VirtualListSource *Source;
+      int ColumnCount;
+      unsigned int CacheSize, BucketMask, MostRecent, LeastRecent;
+      struct VirtualListRow *Row;
+      unsigned int *Bucket;
+      unsigned long Hits, Misses;
+
+      struct VirtualListRow *Fetch( unsigned long );
+      void Discard( unsigned int );
+      void Promote( unsigned int );
+      void Flush();
+  };
+
+  class DataViewEngine: public VirtualListSource
+  {
+    /* A sorted and filtered view of a snapshot of another data source;
+     * Load() takes a columnar copy of every row of the underlying source,
+     * after which Query() submits a sort and filter request, which is
+     * evaluated on a background thread, to yield a permutation of row
+     * indices; any request still in progress, when a newer one arrives,
+     * is abandoned.  On completion, the permutation is published, and a
+     * nominated message is posted to a nominated window, (with the query
+     * generation as its WPARAM); the user interface thread should then
+     * call Collect(), to adopt the new permutation, before refreshing any
+     * VirtualListWindow which presents this view.
+     */
+    public:
+      DataViewEngine( int );
+      ~DataViewEngine();
+
+      void Load( VirtualListSource * );
+      void Attach( HWND, unsigned int );
+
+      /* Query arguments are the sort column, (or -1, to retain the
+       * source order), the sort direction, the filter text, (matched as
+       * a case insensitive substring), and the column to which the filter
+       * applies, (or -1, to match any column); the return value is the
+       * generation number of the submitted query.
+       */
+      unsigned long Query( int, bool = false, const char * = NULL, int = -1 );
+      bool Collect();
+
+      unsigned long RowCount();
+      unsigned long SourceRow( unsigned long );
+      void FetchText( unsigned long, int, char *, size_t );
+
+    private:
+      int ColumnCount;
+      unsigned long RowTotal;
+      struct DataViewColumn *Column;
+      struct DataViewResult *Current;
+      struct DataViewResult * volatile Published;
+
+      int SortColumn, FilterColumn;
+      bool Descending;
+      char *Filter;
+
+      HWND Window;
+      unsigned int Message;
+
+      volatile LONG Generation;
+      volatile bool Terminate;
+      CRITICAL_SECTION Guard, Lock;
+      HANDLE Wakeup, Thread;
+
+      static unsigned __stdcall Worker( void * );
+      struct DataViewResult *Evaluate( LONG, int, bool, const char *, int );
+      int Compare( int, unsigned long, unsigned long );
+      bool Matches( unsigned long, const char *, int );
+      void Release();
+  };
+
+  /* The number of hash buckets used to hold trigram posting lists,
+   * within a SearchIndex; this must be a power of two.
+   */
+# define WTK_SEARCH_BUCKETS  65536
+
+  class SearchIndex: public VirtualListSource
+  {
+    /* A type-ahead search index, mapping arbitrary keys to text, with
+     * each text indexed by the hashes of the trigrams it contains, (the
+     * posting lists); the search for any pattern, of three or more chars,
+     * is confined to the shortest posting list for any of its trigrams,
+     * and, when the pattern contains the pattern of the previous search,
+     * to the result of that search.  All matching is case insensitive.
+     *
+     * When attached to another data source, the index presents the rows
+     * of that source which match the most recent pattern, (or all rows,
+     * before any search), and so may be used as the data source for a
+     * VirtualListWindow, which is refreshed after each search.
+     */
+    public:
+      SearchIndex();
+      ~SearchIndex();
+
+      void Attach( VirtualListSource *, int );
+      void Add( unsigned long, const char * );
+      void Remove( unsigned long );
+
+      /* Search() returns the number of matches for a specified pattern;
+       * Match() then returns the key for any one of them, in the order in
+       * which they were added.
+       */
+      unsigned long Search( const char * );
+      unsigned long Match( unsigned long );
+
+      unsigned long RowCount();
+      void FetchText( unsigned long, int, char *, size_t );
+
+    private:
+      VirtualListSource *Source;
+      struct SearchEntry *Entry;
+      struct SearchPosting *Posting;
+      unsigned int *KeyMap, *Result;
+      unsigned int EntryCount, EntrySize, DeadCount, KeyMapMask;
+      unsigned int ResultCount, ResultSize;
+      char *Pattern;
+      bool Narrowable;
+
+      void Index( unsigned int );
+      unsigned int Lookup( unsigned long );
+      void Rehash( unsigned int );
+      void Compact();
+  };
+
+  /* The timer identifier which is reserved for use by ScrollHelper
+   * objects, (applications must not use it for other timers, on any
+   * window which uses a ScrollHelper), and the frame interval, in
+   * milliseconds, at which it applies accumulated scroll movements.
+   */
+# define WTK_SCROLL_TIMER  0x5C01
+# define WTK_SCROLL_FRAME	 16
+
+  class ScrollHelper
+  {
+    /* A utility class, to manage the scroll bars and scroll offset of
+     * a window; the window's OnHorizontalScroll(), OnVerticalScroll(),
+     * OnMouseWheel() and OnTimer() handlers should delegate to the methods
+     * of the same names, and its OnSize() handler should call SetView().
+     * Scroll requests update a target offset; once per frame, the window
+     * content is moved towards it, by a single ScrollWindowEx() call, so
+     * that only the newly exposed strips need be repainted.  Offsets are
+     * expressed in units, (e.g. lines), of a specified size in pixels; the
+     * window's OnPaint() handler should draw relative to X() and Y().
+     */
+    public:
+      ScrollHelper( bool = false );
+      void Attach( HWND );
+
+      void SetUnit( int, int );
+      void SetExtent( long, long );
+      void SetView( int, int );
+      void SetKinetic( bool kinetic ){ Kinetic = kinetic; }
+
+      void ScrollTo( long, long );
+      void ScrollBy( long, long );
+      long X(){ return Offset[0]; }
+      long Y(){ return Offset[1]; }
+
+      long OnHorizontalScroll( int code ){ return OnScroll( SB_HORZ, code ); }
+      long OnVerticalScroll( int code ){ return OnScroll( SB_VERT, code ); }
+      long OnMouseWheel( WPARAM );
+      long OnTimer( WPARAM );
+
+    private:
+      HWND Window;
+      bool Kinetic, FramePending;
+      int Unit[2], View[2];
+      long Extent[2], Offset[2], Target[2], WheelRemainder;
+
+      long OnScroll( int, int );
+      long Clamp( int, long );
+      void Schedule();
+      void Update( int );
+  };
+
+  /* Configuration of the TextViewWindow class: the file is indexed, and
+   * viewed, through mappings of WTK_TEXTVIEW_CHUNK bytes, (a multiple of
+   * the system allocation granularity), of which WTK_TEXTVIEW_VIEWS may be
+   * held for display at any time; line offsets are indexed in pages of
+   * WTK_TEXTVIEW_PAGE entries, and display of any one line is truncated
+   * at WTK_TEXTVIEW_LINE_MAX bytes.  The indexer reports its progress to
+   * the view window itself, by posting WTK_TEXTVIEW_INDEXED.
+   */
+# define WTK_TEXTVIEW_CHUNK	 0x00400000UL
+# define WTK_TEXTVIEW_VIEWS		  4
+# define WTK_TEXTVIEW_PAGE	      65536
+# define WTK_TEXTVIEW_PAGES	      65536
+# define WTK_TEXTVIEW_LINE_MAX	       1024
+# define WTK_TEXTVIEW_INDEXED  (WM_USER + 1)
+
+  class TextViewWindow: public ChildWindowMaker
+  {
+    /* A stock window class, presenting a read-only view of a text file
+     * of arbitrary size; the file is memory mapped, rather than read, and
+     * the offset of each line is indexed by a background thread, so that
+     * the file may be displayed, and scrolled, while that index is still
+     * being built.  Only those lines which are visible are painted.
+     */
+    public:
+      TextViewWindow( HINSTANCE );
+      ~TextViewWindow();
+
+      HWND Create( int, HWND, unsigned long = WS_BORDER );
+      void Defer( int id, HWND parent, unsigned long style = WS_BORDER )
+      { ChildWindowMaker::Defer( id, parent, "TextView", style ); }
+      bool Open( const char * );
+      void Close();
+
+      /* Progress of the line indexer.
+       */
+      unsigned long LineCount(){ return IndexedLines; }
+      bool IsIndexed(){ return Indexed; }
+
+    protected:
+      long Controller( unsigned, WPARAM, LPARAM );
+      long OnSize( WPARAM, int, int );
+      long OnVerticalScroll( int, int, HWND );
+      long OnPaint();
+      HWND OnRealise( int id, HWND parent, const char *, unsigned long style )
+      { return Create( id, parent, style ); }
+
+    private:
+      static const char *ClassName;
+      const char *RegisteredClassName( void );
+
+      HANDLE File, Mapping, Indexer;
+      ULONGLONG FileSize;
+      ULONGLONG **Page;
+      volatile LONG IndexedLines, ProgressPending;
+      volatile bool Indexed, Cancelled;
+
+      struct TextViewMapping
+      {
+	ULONGLONG base;
+	size_t size;
+	const char *data;
+      } View[WTK_TEXTVIEW_VIEWS];
+      unsigned int NextView;
+
+      unsigned long TopLine, PageLines, ShownLines;
+      int LineHeight;
+      HFONT Font;
+
+      static unsigned __stdcall Worker( void * );
+      void Index();
+      void ReportProgress();
+      unsigned long Lines();
+      ULONGLONG LineOffset( unsigned long i ){ return Page[i / WTK_TEXTVIEW_PAGE][i % WTK_TEXTVIEW_PAGE]; }
+      const char *Map( ULONGLONG, size_t );
+      void UpdateScrollRange();
+      void ScrollTo( unsigned long );
+  };
+
+  /* Configuration of the LogPaneWindow class: the default capacity of
+   * the ring, through which lines are passed from producer threads, (a
+   * power of two), the default number of lines retained for display, the
+   * maximum length of any one line, (longer lines are truncated), and the
+   * default rate, in frames per second, at which the display is updated.
+   */
+# define WTK_LOGPANE_RING	   4096
+# define WTK_LOGPANE_HISTORY	  10000
+# define WTK_LOGPANE_LINE_MAX	    250
+# define WTK_LOGPANE_FPS	     30
+
+  class LogPaneWindow: public ChildWindowMaker
+  {
+    /* A stock window class, presenting a scrolling log of text lines,
+     * which may be appended at high rates, by any number of threads; the
+     * Append() method never blocks, and never calls into the user interface
+     * thread, but simply places the line into a bounded, lock-free ring,
+     * (or discards it, if the ring is full).  The user interface thread
+     * drains the ring at a capped frame rate, painting only those lines
+     * which have been added since the preceding frame.
+     */
+    public:
+      LogPaneWindow( HINSTANCE,
+	  unsigned int = WTK_LOGPANE_RING, unsigned int = WTK_LOGPANE_HISTORY
+	);
+      ~LogPaneWindow();
+
+      HWND Create( int, HWND, unsigned long = WS_BORDER, unsigned int = WTK_LOGPANE_FPS );
+      void Defer( int id, HWND parent, unsigned long style = WS_BORDER,
+	  unsigned int rate = WTK_LOGPANE_FPS
+	){ DeferredRate = rate; ChildWindowMaker::Defer( id, parent, "LogPane", style ); }
+      bool Append( const char * );
+
+      /* Ring statistics: the fraction of its capacity currently in use,
+       * and the number of lines accepted, and discarded, to date.
+       */
+      double FillRatio();
+      unsigned long AppendedLines(){ return Appended; }
+      unsigned long DroppedLines(){ return Dropped; }
+
+    protected:
+      long OnTimer( WPARAM );
+      long OnSize( WPARAM, int, int );
+      long OnVerticalScroll( int, int, HWND );
+      long OnPaint();
+      long OnDestroy();
+      HWND OnRealise( int id, HWND parent, const char *, unsigned long style )
+      { return Create( id, parent, style, DeferredRate ); }
+
+    private:
+      static const char *ClassName;
+      const char *RegisteredClassName( void );
+      unsigned int DeferredRate;
+
+      struct LogPaneSlot *Ring;
+      unsigned int RingMask;
+      volatile LONG EnqueuePos, DequeuePos, Appended, Dropped;
+
+      char *History;
+      unsigned int HistorySize;
+      unsigned long LineTotal, TopLine, PageLines;
+      int LineHeight;
+      HFONT Font;
+
+      unsigned long FirstLine()
+      { return (LineTotal > HistorySize) ? LineTotal - HistorySize : 0; }
+      const char *Line( unsigned long i )
+      { return History + (i % HistorySize) * WTK_LOGPANE_LINE_MAX; }
+
+      unsigned long Drain();
+      void UpdateScrollRange();
+      void ScrollTo( unsigned long );
+  };
+
+  /* The default thickness of a sash bar, in pixels at 96 DPI.
+   */
+# define WTK_SASH_THICKNESS  4
+
   class SashWindowMaker: public ChildWindowMaker
   {
     /* An abstract base class, providing the basis for implementation
@@ -261,6 +1726,30 @@ namespace WTK
 
     public:
       int Displacement( int span = 1 ){ return (int)(DisplacementFactor * span); }
+
+      /* Accessors for the displacement factor itself, (e.g. to save and
+       * restore it); a restored factor is constrained to the valid range.
+       */
+      double GetDisplacementFactor(){ return DisplacementFactor; }
+      void RestoreDisplacementFactor( double factor )
+      { DisplacementFactor = factor; ValidateDisplacementFactor(); }
+
+      /* The thickness, in pixels, with which the owner's layout code
+       * should place the sash bar, for the DPI of its current monitor.
+       * This is evaluated afresh, rather than from the cached Dpi(), since
+       * the owner recomputes its layout on WM_DPICHANGED, before the sash
+       * bar itself is notified of the change.
+       */
+      int Thickness( int design = WTK_SASH_THICKNESS )
+      { return DpiScale::Scale( design, DpiScale::ForWindow( AppWindow ) ); }
+
+      /* Place the sash bar within a specified frame, (in the owner's client
+       * co-ordinates), centred on its displacement, and with the specified
+       * design thickness, scaled by Thickness(); return the bounds of the
+       * two panes which it separates, (left and right, or top and bottom).
+       * This is intended to be called by the owner's AdjustLayout() method.
+       */
+      virtual void Place( const RECT *, RECT *, RECT *, int = WTK_SASH_THICKNESS ) = 0;
   };
 
   class HorizontalSashWindowMaker: public SashWindowMaker
@@ -276,6 +1765,8 @@ namespace WTK
       ): SashWindowMaker( app, minval, initval, maxval )
       { Create( id, owner, RegisteredClassName(), WS_BORDER ); }
 
+      void Place( const RECT *, RECT *, RECT *, int = WTK_SASH_THICKNESS );
+
     private:
       static const char *ClassName;
       const char *RegisteredClassName( void );
@@ -297,6 +1788,8 @@ namespace WTK
       ): SashWindowMaker( app, minval, initval, maxval )
       { Create( id, owner, RegisteredClassName(), WS_BORDER ); }
 
+      void Place( const RECT *, RECT *, RECT *, int = WTK_SASH_THICKNESS );
+
     private:
       static const char *ClassName;
       const char *RegisteredClassName( void );
@@ -304,6 +1797,64 @@ namespace WTK
       void SetClippingRegion( long, long, long );
       void SetDisplacementFactor( unsigned long );
   };
+
+  /* The identifying signature, and format version, of the files which are
+   * written by StateSnapshot.
+   */
+# define WTK_STATE_SIGNATURE  0x534B5457UL
+# define WTK_STATE_VERSION    1
+
+  class StateSnapshot
+  {
+    /* A persistent record of user interface state: window placements,
+     * sash displacement factors, and arbitrary layout values, (e.g. column
+     * widths), each registered under a unique name.  On construction, any
+     * existing snapshot file is mapped into memory; Restore() should then be
+     * called, after all state has been registered, but before any window is
+     * first shown, to apply every recorded value, so that the first layout,
+     * and first paint, are already final.  Save() captures the current state,
+     * (on the calling thread, which must be the user interface thread), and
+     * hands it to a background thread, which writes it to a temporary file,
+     * then replaces the snapshot file with it; it may be called whenever the
+     * state changes, and should be called before the windows are destroyed,
+     * at exit.  The destructor waits for any pending write to complete.
+     */
+    public:
+      StateSnapshot( const char * );
+      ~StateSnapshot();
+
+      void Register( const char *, HWND );
+      void Register( const char *, SashWindowMaker * );
+      void Register( const char *, long * );
+      void Register( const char *, double * );
+
+      bool Restore();
+      void Save();
+
+      /* The mode in which a restored main window should be shown, given
+       * the mode which would otherwise be used; (this restores a maximized
+       * state, which cannot be applied to a window which is not yet shown).
+       */
+      int ShowMode( int );
+
+    private:
+      char *Path;
+      HANDLE File, Mapping;
+      const struct StateHeader *Snapshot;
+      struct StateItem *Item;
+      unsigned int ItemCount, ItemSize;
+      UINT RestoredShow;
+
+      CRITICAL_SECTION Lock;
+      struct StateHeader *Pending;
+      HANDLE Wake, Thread;
+      volatile LONG Stopping;
+
+      void Add( const char *, int, void * );
+      void Release();
+      static unsigned __stdcall Writer( void * );
+      bool Write( struct StateHeader * );
+  };
 }
 #endif /* __cplusplus */
 
@@ -319,6 +1870,7 @@ BEGIN_NAMESPACE( WTK )
    * the namespace when compiling C++.
    */
   EXTERN_C int RaiseAppWindow( HINSTANCE, unsigned int );
+  EXTERN_C int RaiseWindow( HWND );
 
   static __inline__
   int ChangeCaption( HWND window, const char *caption )
@@ -0,0 +1,345 @@
+/*
+ * wtklog.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation for the LogPaneWindow class, which
+ * presents a scrolling log of text lines, appended by any number of threads
+ * through a bounded lock-free ring, and displayed at a capped frame rate.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <string.h>
+#include "wtklite.h"
+
+/* The identifier for the frame rate timer, which each pane sets
+ * for its own window.
+ */
+#define WTK_LOGPANE_TIMER  1
+
+namespace WTK
+{
+  struct LogPaneSlot
+  {
+    /* Each slot in the ring carries a sequence number, which denotes
+     * whether it is free for the producer which claims the position with
+     * the same number, or is ready for the consumer, (when it is one more
+     * than that position); this arbitrates between producers, and between
+     * producers and consumer, without any lock.
+     */
+    volatile LONG sequence;
+    char text[WTK_LOGPANE_LINE_MAX];
+  };
+
+  static inline LONG Advance( LONG position, unsigned long count )
+  {
+    /* Helper to advance a ring position, with well defined wrapping.
+     */
+    return (LONG)((unsigned long)(position) + count);
+  }
+
+  LogPaneWindow::LogPaneWindow
+  ( HINSTANCE app, unsigned int capacity, unsigned int history ):
+  ChildWindowMaker( app ), DeferredRate( WTK_LOGPANE_FPS ), RingMask( 1 ),
+  EnqueuePos( 0 ), DequeuePos( 0 ), Appended( 0 ), Dropped( 0 ),
+  HistorySize( history ? history : 1 ),
+  LineTotal( 0 ), TopLine( 0 ), PageLines( 0 ), LineHeight( 0 ),
+  Font( (HFONT)(GetStockObject( ANSI_FIXED_FONT )) )
+  {
+    /* Allocate the ring, with capacity rounded up to a power of two,
+     * and storage for the retained display lines.
+     */
+    while( RingMask < capacity ) RingMask <<= 1;
+    Ring = (LogPaneSlot *)(malloc( RingMask * sizeof( LogPaneSlot )));
+    History = (char *)(malloc( HistorySize * WTK_LOGPANE_LINE_MAX ));
+    if( (Ring == NULL) || (History == NULL) )
+    {
+      free( (void *)(Ring) ); free( (void *)(History) );
+      throw( runtime_error( "Insufficient memory" ) );
+    }
+    for( unsigned int i = 0; i < RingMask; i++ ) Ring[i].sequence = i;
+    --RingMask;
+  }
+
+  const char *LogPaneWindow::ClassName = NULL;
+  const char *LogPaneWindow::RegisteredClassName( void )
+  {
+    /* Helper routine to ensure that the appropriate window class
+     * name is registered on first instantiation of any class object,
+     * (by whichever thread first instantiates one).
+     */
+    if( ClassName == NULL )
+    {
+      static volatile LONG lock = 0; SpinLock hold( &lock );
+      if( ClassName == NULL )
+      {
+	WindowClassMaker WindowClassRegistry( AppInstance );
+	WindowClassRegistry.Register( "LogPane" ); ClassName = "LogPane";
+      }
+    }
+    return ClassName;
+  }
+
+  HWND LogPaneWindow::Create
+  ( int id, HWND parent, unsigned long style, unsigned int rate )
+  {
+    /* Create the pane window, establish the line height for its font,
+     * and start the timer which paces its display updates.
+     */
+    ChildWindowMaker::Create( id, parent, RegisteredClassName(), style | WS_VSCROLL );
+    TEXTMETRIC metrics; HDC dc = GetDC( AppWindow );
+    HGDIOBJ original = SelectObject( dc, Font );
+    GetTextMetrics( dc, &metrics ); LineHeight = metrics.tmHeight;
+    SelectObject( dc, original ); ReleaseDC( AppWindow, dc );
+    SetTimer( AppWindow, WTK_LOGPANE_TIMER, 1000 / (rate ? rate : 1), NULL );
+    UpdateScrollRange();
+    return AppWindow;
+  }
+
+  bool LogPaneWindow::Append( const char *text )
+  {
+    /* Append one line to the log; this may be called concurrently, by
+     * any thread.  Returns false, if the line is discarded, because the
+     * ring is full.
+     */
+    LogPaneSlot *slot;
+    LONG position = EnqueuePos;
+    for(;;)
+    {
+      /* Claim the next ring position, provided the consumer has released
+       * its slot, competing with other producers to do so.
+       */
+      slot = Ring + (position & RingMask);
+      LONG lag = Advance( slot->sequence, -(unsigned long)(position) );
+      if( lag == 0 )
+      {
+	LONG seen = InterlockedCompareExchange( &EnqueuePos, Advance( position, 1 ), position );
+	if( seen == position ) break;
+	position = seen;
+      }
+      else if( lag < 0 )
+      {
+	InterlockedIncrement( &Dropped );
+	return false;
+      }
+      else position = EnqueuePos;
+    }
+    /* The slot is now exclusively ours; fill it, then publish it to the
+     * consumer, (the interlocked store orders the preceding writes).
+     */
+    size_t len = strlen( text );
+    while( (len > 0) && ((text[len - 1] == '\n') || (text[len - 1] == '\r')) ) --len;
+    if( len >= WTK_LOGPANE_LINE_MAX ) len = WTK_LOGPANE_LINE_MAX - 1;
+    memcpy( slot->text, text, len ); slot->text[len] = '\0';
+    InterlockedExchange( &(slot->sequence), Advance( position, 1 ) );
+    InterlockedIncrement( &Appended );
+    return true;
+  }
+
+  double LogPaneWindow::FillRatio()
+  {
+    /* Estimate the fraction of the ring currently occupied; (this is
+     * necessarily approximate, while producers are active).
+     */
+    LONG used = Advance( EnqueuePos, -(unsigned long)(DequeuePos) );
+    if( used <= 0 ) return 0.0;
+    double ratio = (double)(used) / (RingMask + 1.0);
+    return (ratio > 1.0) ? 1.0 : ratio;
+  }
+
+  unsigned long LogPaneWindow::Drain()
+  {
+    /* Helper, called only on the user interface thread, to transfer all
+     * lines which are ready in the ring, (but no more than one ring full,
+     * in any one frame), to the display history.
+     */
+    unsigned long count = 0;
+    while( count <= RingMask )
+    {
+      LONG position = DequeuePos;
+      LogPaneSlot *slot = Ring + (position & RingMask);
+      if( slot->sequence != Advance( position, 1 ) ) break;
+      memcpy( (void *)(Line( LineTotal++ )), slot->text, WTK_LOGPANE_LINE_MAX );
+      InterlockedExchange( &(slot->sequence), Advance( position, RingMask + 1 ) );
+      DequeuePos = Advance( position, 1 ); ++count;
+    }
+    return count;
+  }
+
+  void LogPaneWindow::UpdateScrollRange()
+  {
+    /* Helper to adjust the vertical scroll bar, to reflect the number of
+     * lines retained in the display history.
+     */
+    SCROLLINFO info;
+    info.cbSize = sizeof( info );
+    info.fMask = SIF_RANGE | SIF_PAGE | SIF_POS;
+    info.nMin = 0; info.nMax = (int)(LineTotal - FirstLine()) - 1;
+    info.nPage = PageLines; info.nPos = TopLine - FirstLine();
+    SetScrollInfo( AppWindow, SB_VERT, &info, TRUE );
+  }
+
+  void LogPaneWindow::ScrollTo( unsigned long line )
+  {
+    /* Helper to move a specified line to the top of the pane; where the
+     * movement is less than one page, the content which remains visible
+     * is scrolled, so that only the exposed lines are repainted.
+     */
+    unsigned long first = FirstLine(), limit = LineTotal;
+    limit = (limit > (first + PageLines)) ? limit - PageLines : first;
+    if( line > limit ) line = limit;
+    if( line < first ) line = first;
+    if( line != TopLine )
+    {
+      long delta = (long)(TopLine) - (long)(line);
+      if( (unsigned long)(labs( delta )) < PageLines )
+	ScrollWindowEx( AppWindow, 0, delta * LineHeight, NULL, NULL, NULL, NULL,
+	    SW_INVALIDATE | SW_ERASE
+	  );
+      else InvalidateRect( AppWindow, NULL, TRUE );
+      TopLine = line;
+    }
+  }
+
+  long LogPaneWindow::OnTimer( WPARAM id )
+  {
+    /* Once per frame, drain the ring; if the pane was showing the tail
+     * of the log, it continues to follow it, by scrolling the existing
+     * content, and painting only the newly added lines.
+     */
+    if( id != WTK_LOGPANE_TIMER ) return 1L;
+    unsigned long previous = LineTotal;
+    bool following = (TopLine + PageLines) >= previous;
+    if( Drain() > 0 )
+    {
+      if( following ) ScrollTo( LineTotal );
+      else ScrollTo( TopLine );
+
+      /* Lines appended below the last visible line, while the pane is
+       * not yet full, are exposed without scrolling.
+       */
+      if( (previous < (TopLine + PageLines + 1)) && (previous >= TopLine) )
+      {
+	RECT exposed; GetClientRect( AppWindow, &exposed );
+	exposed.top = (previous - TopLine) * LineHeight;
+	InvalidateRect( AppWindow, &exposed, TRUE );
+      }
+      UpdateScrollRange(); UpdateWindow( AppWindow );
+    }
+    return 0L;
+  }
+
+  long LogPaneWindow::OnSize( WPARAM mode, int width, int height )
+  {
+    /* Recompute the number of whole lines which fit the pane.
+     */
+    if( LineHeight > 0 ) PageLines = height / LineHeight;
+    ScrollTo( TopLine ); UpdateScrollRange();
+    return 0L;
+  }
+
+  long LogPaneWindow::OnVerticalScroll( int code, int position, HWND control )
+  {
+    /* Handle scroll bar actions; scroll positions are relative to the
+     * first retained line.
+     */
+    unsigned long line = TopLine;
+    switch( code )
+    {
+      case SB_LINEUP:	line = line ? line - 1 : 0; break;
+      case SB_LINEDOWN:	line = line + 1; break;
+      case SB_PAGEUP:	line = (line > PageLines) ? line - PageLines : 0; break;
+      case SB_PAGEDOWN:	line = line + PageLines; break;
+      case SB_TOP:	line = 0; break;
+      case SB_BOTTOM:	line = LineTotal; break;
+
+      case SB_THUMBTRACK:
+      case SB_THUMBPOSITION:
+	{ SCROLLINFO info;
+	  info.cbSize = sizeof( info ); info.fMask = SIF_TRACKPOS;
+	  GetScrollInfo( AppWindow, SB_VERT, &info );
+	  line = FirstLine() + info.nTrackPos;
+	}
+	break;
+
+      default:
+	return 0L;
+    }
+    ScrollTo( line ); UpdateScrollRange();
+    return 0L;
+  }
+
+  long LogPaneWindow::OnPaint()
+  {
+    /* Paint only those retained lines which intersect the update region.
+     */
+    PAINTSTRUCT ps; HDC dc = BeginPaint( AppWindow, &ps );
+    if( LineHeight > 0 )
+    {
+      HGDIOBJ original = SelectObject( dc, Font );
+      SetBkMode( dc, TRANSPARENT );
+      SetTextColor( dc, GetSysColor( COLOR_WINDOWTEXT ) );
+
+      unsigned long line = TopLine + ps.rcPaint.top / LineHeight;
+      unsigned long last = TopLine + (ps.rcPaint.bottom - 1) / LineHeight;
+      if( line < FirstLine() ) line = FirstLine();
+      for( ; (line <= last) && (line < LineTotal); line++ )
+      {
+	const char *text = Line( line );
+	TabbedTextOut( dc, 2, (line - TopLine) * LineHeight, text, strlen( text ), 0, NULL, 0 );
+      }
+      SelectObject( dc, original );
+    }
+    EndPaint( AppWindow, &ps );
+    return 0L;
+  }
+
+  long LogPaneWindow::OnDestroy()
+  {
+    /* Stop the frame rate timer, when the pane window is destroyed.
+     */
+    KillTimer( AppWindow, WTK_LOGPANE_TIMER );
+    return 0L;
+  }
+
+  LogPaneWindow::~LogPaneWindow()
+  {
+    /* Release the ring, and the display history; (producers must not
+     * append to a pane which is being destroyed).
+     */
+    free( (void *)(Ring) ); free( (void *)(History) );
+  }
+}
+
+/* $RCSfile$: end of file */
@@ -9,10 +9,11 @@
  * $Id$
  *
  * This file provides the implementation for the standard methods of
- * the MainWindowMaker class.
+ * the MainWindowMaker class, including the message loop, and the means
+ * whereby EventMonitor objects, and MessageLanes, are attached to it.
  *
  * Written by Keith Marshall <keithmarshall@users.sourceforge.net>
- * Copyright (C) 2012, MinGW.org Project.
+ * Copyright (C) 2012, 2026, MinGW.org Project.
  *
  * ---------------------------------------------------------------------------
  *
@@ -48,25 +49,109 @@ namespace WTK
   {
     /* Initiate the message processing loop for the main window.
      */
-    MSG message; int status;
-    while( (status = GetMessage( &message, NULL, 0, 0 )) != 0 )
+    MSG message;
+    while( true )
     {
-      if( status == -1 )
+      /* First, dispatch all messages which are currently queued,
+       * until the quit message is retrieved...
+       */
+      while( PeekMessage( &message, NULL, 0, 0, PM_REMOVE ) )
+      {
+	if( message.message == WM_QUIT )
+	  return (int)(message.wParam);
+
+	if( ! ModelessDialogue::Dispatch( &message ) )
+	{
+	  TranslateMessage( &message );
+	  DispatchMessage( &message );
+	}
+      }
+
+      /* ...then wait for either the arrival of further messages, or
+       * for any attached event monitor to become signalled; we rotate
+       * the order in which monitors are presented, so that no single
+       * persistently signalled object may starve any other.
+       */
+      HANDLE event[WTK_MONITORS_MAX]; EventMonitor *client[WTK_MONITORS_MAX];
+      for( unsigned i = 0; i < MonitorCount; i++ )
+      {
+	client[i] = Monitor[(NextMonitor + i) % MonitorCount];
+	event[i] = client[i]->EventHandle();
+      }
+      unsigned long status = MsgWaitForMultipleObjects( MonitorCount, event,
+	  FALSE, INFINITE, QS_ALLINPUT
+	);
+      if( status == WAIT_FAILED )
 	throw( runtime_error( "Unexpected message handler exception" ) );
 
-      else
+      else if( (status -= WAIT_OBJECT_0) < MonitorCount )
       {
-	TranslateMessage( &message );
-	DispatchMessage( &message );
+	/* An event monitor has been signalled; advance the rotation,
+	 * before notifying it, (since the notification handler may
+	 * choose to detach it).
+	 */
+	NextMonitor = (NextMonitor + status + 1) % MonitorCount;
+	client[status]->OnSignalled();
       }
     }
   }
 
+  void MainWindowMaker::AttachMonitor( EventMonitor *client )
+  {
+    /* Add an event monitor to the set which is serviced by the
+     * message loop, (if it has not already been attached).
+     */
+    for( unsigned i = 0; i < MonitorCount; i++ )
+      if( Monitor[i] == client ) return;
+
+    if( MonitorCount >= WTK_MONITORS_MAX )
+      throw( runtime_error( "Too many event monitors" ) );
+    Monitor[MonitorCount++] = client;
+  }
+
+  void MainWindowMaker::DetachMonitor( EventMonitor *client )
+  {
+    /* Remove an event monitor from the set which is serviced
+     * by the message loop, preserving the order of the rest.
+     */
+    for( unsigned i = 0; i < MonitorCount; i++ )
+      if( Monitor[i] == client )
+      {
+	while( ++i < MonitorCount ) Monitor[i - 1] = Monitor[i];
+	if( NextMonitor >= --MonitorCount ) NextMonitor = 0;
+	return;
+      }
+  }
+
+  void MainWindowMaker::AttachLanes( MessageLanes *lanes )
+  {
+    /* Nominate the set of message lanes, (if any), which is to be
+     * serviced by this window's Controller().
+     */
+    if( Lanes != NULL ) Lanes->Attach( NULL );
+    if( (Lanes = lanes) != NULL ) lanes->Attach( AppWindow );
+  }
+
+  long MainWindowMaker::Controller
+  ( unsigned message, WPARAM w_param, LPARAM l_param )
+  {
+    /* Service the attached message lanes, if any, within the window
+     * procedure, (rather than in Invoked()), so that they continue to
+     * be drained while any modal loop is running; all other messages
+     * are processed as for any other window.
+     */
+    if( (Lanes != NULL) && Lanes->Handle( message, w_param ) )
+      return 0L;
+    return WindowMaker::Controller( message, w_param, l_param );
+  }
+
   long MainWindowMaker::OnDestroy()
   {
-    /* When the top level window is being destroyed, we notify the
-     * message loop that the application is terminating.
+    /* When the top level window is being destroyed, we detach any
+     * message lanes, and notify the message loop that the application,
+     * (or only the UIThread which owns this window), is terminating.
      */
+    if( Lanes != NULL ) Lanes->Attach( NULL );
     PostQuitMessage( EXIT_SUCCESS );
     return EXIT_SUCCESS;
   }
@@ -0,0 +1,273 @@
+/*
+ * wtkmeas.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation for the TextCache class, which
+ * retains text extents, and shaped glyph runs, for recently measured or drawn
+ * strings, keyed by font and string content.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <string.h>
+#include "wtklite.h"
+
+/* The number of hash chains, (a power of two), used to look up cached
+ * text entries.
+ */
+#define WTK_TEXTCACHE_BUCKETS  256
+
+/* The number of glyphs, in a run, which Draw() may copy to its own stack
+ * frame; runs of more glyphs are copied to the heap.
+ */
+#define WTK_TEXTCACHE_RUN  256
+
+namespace WTK
+{
+  struct TextCacheEntry
+  {
+    /* Each entry records its font, a copy of its string, the string's
+     * extent and, once it has been drawn, its glyph indices and advance
+     * widths; (a negative glyph count indicates that shaping failed, and
+     * the string must be drawn as text).  Entries are linked into a hash
+     * chain, and the LRU list, most recent first.
+     */
+    HFONT font; unsigned long hash;
+    int length; char *text;
+    SIZE extent;
+    int glyph_count; WORD *glyphs; int *advance;
+    TextCacheEntry *chain, *newer, *older;
+  };
+
+  TextCacheEntry *TextCache::Bucket[WTK_TEXTCACHE_BUCKETS];
+  TextCacheEntry *TextCache::Newest = NULL;
+  TextCacheEntry *TextCache::Oldest = NULL;
+  unsigned int TextCache::Capacity = WTK_TEXTCACHE_ENTRIES;
+  unsigned int TextCache::EntryCount = 0;
+  unsigned long TextCache::HitCount = 0;
+  unsigned long TextCache::MissCount = 0;
+
+  /* All access to the cache is serialised, since it may be shared by
+   * more than one user interface thread; the lock is held only while the
+   * cache is consulted, or updated, and never while text is shaped or
+   * drawn, so that no thread's drawing may be stalled by another's.
+   */
+  static volatile LONG cache_lock = 0;
+
+  TextCacheEntry *TextCache::Lookup( HDC dc, const char *text, int len, bool create )
+  {
+    /* Helper to locate the entry for a string, in the font selected
+     * into a device context, measuring it and adding a new entry, if it is
+     * not already cached, (or returning NULL, if "create" is false); the
+     * entry becomes the most recently used.  The caller must hold the
+     * cache_lock.
+     */
+    HFONT font = (HFONT)(GetCurrentObject( dc, OBJ_FONT ));
+    if( len < 0 ) len = strlen( text );
+    unsigned long hash = 2166136261UL ^ (unsigned long)((ULONG_PTR)(font));
+    for( int i = 0; i < len; i++ ) hash = (hash ^ (unsigned char)(text[i])) * 16777619UL;
+
+    TextCacheEntry *entry = Bucket[hash & (WTK_TEXTCACHE_BUCKETS - 1)];
+    while( (entry != NULL) && ((entry->hash != hash) || (entry->font != font)
+	|| (entry->length != len) || (memcmp( entry->text, text, len ) != 0)) )
+      entry = entry->chain;
+
+    if( entry != NULL )
+    {
+      /* The string is cached; promote it to most recently used.
+       */
+      if( entry != Newest )
+      {
+	entry->newer->older = entry->older;
+	if( entry->older != NULL ) entry->older->newer = entry->newer;
+	else Oldest = entry->newer;
+	entry->newer = NULL; entry->older = Newest;
+	Newest->newer = entry; Newest = entry;
+      }
+      ++HitCount;
+      return entry;
+    }
+
+    /* The string is not cached; measure it, and create a new entry, (but
+     * defer shaping, until it is actually drawn).
+     */
+    if( ! create ) return NULL;
+    if( (entry = (TextCacheEntry *)(malloc( sizeof( TextCacheEntry ) + len ))) == NULL )
+      throw( runtime_error( "Insufficient memory" ) );
+    entry->font = font; entry->hash = hash;
+    entry->length = len; entry->text = (char *)(entry + 1);
+    memcpy( entry->text, text, len );
+    if( ! GetTextExtentPoint32( dc, text, len, &(entry->extent) ) )
+      entry->extent.cx = entry->extent.cy = 0;
+    entry->glyph_count = 0; entry->glyphs = NULL; entry->advance = NULL;
+
+    entry->chain = Bucket[hash & (WTK_TEXTCACHE_BUCKETS - 1)];
+    Bucket[hash & (WTK_TEXTCACHE_BUCKETS - 1)] = entry;
+    entry->newer = NULL;
+    if( (entry->older = Newest) != NULL ) Newest->newer = entry;
+    else Oldest = entry;
+    Newest = entry; ++EntryCount; ++MissCount;
+    Trim( (Capacity > 0) ? Capacity : 1 );
+    return entry;
+  }
+
+  SIZE TextCache::Extent( HDC dc, const char *text, int len )
+  {
+    /* Retrieve the extent of a string, in the currently selected font.
+     */
+    SpinLock hold( &cache_lock );
+    return Lookup( dc, text, len )->extent;
+  }
+
+  BOOL TextCache::Draw
+  ( HDC dc, int x, int y, const char *text, int len, UINT options, const RECT *clip )
+  {
+    /* Draw a string, in the currently selected font, from its cached
+     * glyph run; on first use, the string is shaped by the system, and
+     * the resultant glyph indices and advance widths are retained.  The
+     * glyph run is copied, while the lock is held, so that it may be drawn
+     * after the lock is released, even if another thread should evict it.
+     */
+    if( len < 0 ) len = strlen( text );
+    WORD glyph_run[WTK_TEXTCACHE_RUN], *glyphs = glyph_run;
+    int advance_run[WTK_TEXTCACHE_RUN], *advance = advance_run;
+    int count;
+    {
+      SpinLock hold( &cache_lock );
+      TextCacheEntry *entry = Lookup( dc, text, len );
+      if( (count = entry->glyph_count) >= 0 )
+      {
+	if( len > WTK_TEXTCACHE_RUN )
+	{
+	  glyphs = (WORD *)(malloc( len * sizeof( WORD ) ));
+	  advance = (int *)(malloc( len * sizeof( int ) ));
+	  if( (glyphs == NULL) || (advance == NULL) ) count = -1;
+	}
+	if( count > 0 )
+	{
+	  memcpy( glyphs, entry->glyphs, count * sizeof( WORD ) );
+	  memcpy( advance, entry->advance, count * sizeof( int ) );
+	}
+      }
+    }
+    if( (count == 0) && (len > 0) )
+    {
+      /* The string has yet to be shaped; do so, without holding the lock,
+       * then retain the result, unless the entry has since been evicted,
+       * or another thread has shaped it in the meantime.
+       */
+      GCP_RESULTS shape;
+      memset( &shape, 0, sizeof( shape ) );
+      shape.lStructSize = sizeof( shape );
+      shape.lpGlyphs = (LPWSTR)(glyphs); shape.lpDx = advance; shape.nGlyphs = len;
+      count = (GetCharacterPlacement( dc, text, len, 0, &shape, 0 ) != 0) ? (int)(shape.nGlyphs) : -1;
+
+      SpinLock hold( &cache_lock );
+      TextCacheEntry *entry = Lookup( dc, text, len, false );
+      if( (entry != NULL) && (entry->glyph_count == 0) )
+      {
+	if( count <= 0 ) entry->glyph_count = -1;
+	else if( ((entry->glyphs = (WORD *)(malloc( count * sizeof( WORD ) ))) != NULL)
+	&&  ((entry->advance = (int *)(malloc( count * sizeof( int ) ))) != NULL)  )
+	{
+	  memcpy( entry->glyphs, glyphs, count * sizeof( WORD ) );
+	  memcpy( entry->advance, advance, count * sizeof( int ) );
+	  entry->glyph_count = count;
+	}
+	else { free( (void *)(entry->glyphs) ); entry->glyphs = NULL; }
+      }
+    }
+    BOOL result = (count > 0)
+      ? ExtTextOutW( dc, x, y, options | ETO_GLYPH_INDEX, clip, (LPCWSTR)(glyphs), count, advance )
+      : ExtTextOut( dc, x, y, options, clip, text, len, NULL );
+    if( glyphs != glyph_run ) free( (void *)(glyphs) );
+    if( advance != advance_run ) free( (void *)(advance) );
+    return result;
+  }
+
+  void TextCache::Delete( TextCacheEntry *entry )
+  {
+    /* Helper to discard an entry, removing it from its hash chain, and
+     * from the LRU list.
+     */
+    TextCacheEntry **ref = Bucket + (entry->hash & (WTK_TEXTCACHE_BUCKETS - 1));
+    while( *ref != entry ) ref = &((*ref)->chain);
+    *ref = entry->chain;
+    if( entry->newer != NULL ) entry->newer->older = entry->older;
+    else Newest = entry->older;
+    if( entry->older != NULL ) entry->older->newer = entry->newer;
+    else Oldest = entry->newer;
+    free( (void *)(entry->glyphs) ); free( (void *)(entry->advance) );
+    free( (void *)(entry) ); --EntryCount;
+  }
+
+  void TextCache::Trim( unsigned int limit )
+  {
+    /* Helper to discard least recently used entries, until no more than
+     * a specified number remain.
+     */
+    while( EntryCount > limit ) Delete( Oldest );
+  }
+
+  void TextCache::SetCapacity( unsigned int limit )
+  {
+    /* Adjust the maximum number of entries retained.
+     */
+    SpinLock hold( &cache_lock );
+    Trim( Capacity = limit );
+  }
+
+  void TextCache::Purge()
+  {
+    /* Discard all entries.
+     */
+    SpinLock hold( &cache_lock );
+    Trim( 0 );
+  }
+
+  void TextCache::Forget( HFONT font )
+  {
+    /* Discard all entries for a font which is about to be deleted.
+     */
+    SpinLock hold( &cache_lock );
+    for( TextCacheEntry *entry = Oldest; entry != NULL; )
+    {
+      TextCacheEntry *next = entry->newer;
+      if( entry->font == font ) Delete( entry );
+      entry = next;
+    }
+  }
+}
+
+/* $RCSfile$: end of file */
@@ -0,0 +1,174 @@
+/*
+ * wtknotify.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation for the notification routing
+ * methods of the GenericWindow class; these direct WM_NOTIFY messages to
+ * individual handlers, through a hash table keyed by control ID and by
+ * notification code.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include "wtklite.h"
+
+namespace WTK
+{
+  struct NotificationRoute
+  {
+    /* Each routing table entry associates a handler, (or a request
+     * for reflection, to a specific window object, and its control), with
+     * a control ID and notification code pair.
+     */
+    unsigned int id, code;
+    GenericWindow::NotificationHandler handler;
+    GenericWindow *target; HWND source;
+    bool in_use, reflect;
+  };
+
+  struct NotificationMap
+  {
+    /* The routing table is allocated as a single block, comprising a
+     * header, followed by an open addressed hash table of entries; its
+     * size is always a power of two.
+     */
+    unsigned int size, count;
+    NotificationRoute route[1];
+  };
+
+  static inline unsigned int hash( unsigned int id, unsigned int code )
+  {
+    /* Local helper to compute the initial table slot index for a
+     * specified key; the caller must reduce it modulo table size.
+     */
+    return (id * 2654435761U) ^ (code * 40503U);
+  }
+
+  static NotificationRoute *lookup
+  ( NotificationMap *map, unsigned int id, unsigned int code )
+  {
+    /* Local helper to locate the table entry for a specified key, or
+     * the empty slot in which it should be placed, if not present.
+     */
+    unsigned int slot = hash( id, code );
+    NotificationRoute *ref;
+    while( (ref = map->route + (slot++ & (map->size - 1)))->in_use )
+      if( (ref->id == id) && (ref->code == code) ) break;
+    return ref;
+  }
+
+  void GenericWindow::MapNotification( unsigned int id, unsigned int code,
+      NotificationHandler handler, GenericWindow *target
+  )
+  {
+    /* Add, or replace, a routing table entry; the table is expanded,
+     * by rehashing into a table of twice the size, whenever it would
+     * otherwise become more than half full.
+     */
+    if( (Notifications == NULL) || ((Notifications->count + 1) > (Notifications->size >> 1)) )
+    {
+      unsigned int size = Notifications ? Notifications->size << 1 : 16;
+      NotificationMap *map = (NotificationMap *)(calloc( 1,
+	    sizeof( NotificationMap ) + (size - 1) * sizeof( NotificationRoute )
+	  ));
+      if( map == NULL ) throw( runtime_error( "Insufficient memory" ) );
+      map->size = size;
+      if( Notifications != NULL )
+      {
+	for( unsigned int i = 0; i < Notifications->size; i++ )
+	  if( Notifications->route[i].in_use )
+	    *lookup( map, Notifications->route[i].id, Notifications->route[i].code )
+	      = Notifications->route[i];
+	map->count = Notifications->count;
+	free( (void *)(Notifications) );
+      }
+      Notifications = map;
+    }
+    NotificationRoute *ref = lookup( Notifications, id, code );
+    if( ! ref->in_use ) ++Notifications->count;
+    ref->id = id; ref->code = code; ref->handler = handler;
+    ref->target = target; ref->source = (target != NULL) ? target->AppWindow : NULL;
+    ref->reflect = (target != NULL); ref->in_use = true;
+  }
+
+  void GenericWindow::RouteNotification
+  ( unsigned int id, unsigned int code, NotificationHandler handler )
+  {
+    /* Route notifications, from a specified control, to a specified
+     * member handler, within this window object.
+     */
+    MapNotification( id, code, handler, NULL );
+  }
+
+  void GenericWindow::ReflectNotification( GenericWindow *control, unsigned int code )
+  {
+    /* Reflect notifications, from the control which is represented by a
+     * specified window object, (which must already have been created), back
+     * to that object.  The object, and the control's window handle, are both
+     * recorded, so that nothing need be inferred from the originating window
+     * itself, (whose GWLP_USERDATA may belong to some other party).
+     */
+    MapNotification( GetDlgCtrlID( control->AppWindow ), code, NULL, control );
+  }
+
+  long GenericWindow::DispatchNotification( WPARAM w_param, LPARAM l_param )
+  {
+    /* Invoked by the Controller(), to handle a WM_NOTIFY message; look
+     * for a routing table entry for the specific notification code, or
+     * failing that, for the wildcard code...
+     */
+    NMHDR *hdr = (NMHDR *)(l_param);
+    if( Notifications != NULL )
+    {
+      unsigned int id = (unsigned int)(hdr->idFrom);
+      NotificationRoute *ref = lookup( Notifications, id, hdr->code );
+      if( ! ref->in_use ) ref = lookup( Notifications, id, WTK_NOTIFY_ANY );
+      if( ref->in_use )
+      {
+	/* ...and when one is found, dispatch accordingly.
+	 */
+	if( ! ref->reflect ) return (this->*(ref->handler))( hdr );
+	if( hdr->hwndFrom == ref->source ) return ref->target->OnReflectedNotify( hdr );
+      }
+    }
+    /* When there is no routing table entry, or the notification could
+     * not be reflected, fall back to the catch-all handler, or to the
+     * default window procedure.
+     */
+    if( OnNotify( w_param, l_param ) == 0L ) return 0L;
+    return DefWindowProc( AppWindow, WM_NOTIFY, w_param, l_param );
+  }
+}
+
+/* $RCSfile$: end of file */
@@ -0,0 +1,442 @@
+/*
+ * wtkpixel.c
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation of the pixel processing kernels,
+ * which are declared in wtkpixel.h; each has a scalar implementation, and,
+ * when compiled by a sufficiently recent GCC for an x86 target, SSE2 and AVX2
+ * implementations, one of which is selected at run time.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#include "wtkpixel.h"
+
+#if defined __GNUC__ && (defined __i386__ || defined __x86_64__) \
+ && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))
+/* This compiler allows SIMD intrinsics to be used within individual
+ * functions, (identified by target attributes), without requiring that
+ * the whole translation unit be compiled for the corresponding instruction
+ * set; thus we may provide the SIMD kernels, and choose whether to use them
+ * at run time, according to the capabilities of the processor.
+ */
+#include <immintrin.h>
+#define WTK_PIXEL_SIMD  1
+#define SSE2_TARGET  __attribute__((__target__("sse2")))
+#define AVX2_TARGET  __attribute__((__target__("avx2")))
+#endif
+
+static __inline__ unsigned div255( unsigned x )
+{
+  /* Helper to divide by 255, rounding to nearest, for any product of
+   * two 8-bit values; the SIMD kernels use the identical computation.
+   */
+  x += 128; return (x + (x >> 8)) >> 8;
+}
+
+static __inline__ uint32_t over( uint32_t d, uint32_t s )
+{
+  /* Helper to composite one premultiplied pixel over another; for
+   * consistency with the SIMD kernels, each component sum saturates.
+   */
+  unsigned ia = 255 - (s >> 24), shift; uint32_t result = 0;
+  for( shift = 0; shift < 32; shift += 8 )
+  {
+    unsigned c = ((s >> shift) & 0xFF) + div255( ((d >> shift) & 0xFF) * ia );
+    result |= (uint32_t)((c > 255) ? 255 : c) << shift;
+  }
+  return result;
+}
+
+static __inline__ uint32_t scale( uint32_t s, unsigned m )
+{
+  /* Helper to scale every component of a pixel by a coverage value.
+   */
+  unsigned shift; uint32_t result = 0;
+  for( shift = 0; shift < 32; shift += 8 )
+    result |= (uint32_t)(div255( ((s >> shift) & 0xFF) * m )) << shift;
+  return result;
+}
+
+static __inline__ unsigned weight( int32_t position )
+{
+  /* Helper to convert a 16.16 gradient position to an 8.8 weight for
+   * the final colour, in the range 0..256.
+   */
+  if( position < 0 ) return 0;
+  return (position > 0x10000) ? 256 : (unsigned)(position) >> 8;
+}
+
+static __inline__ uint32_t mix( uint32_t from, uint32_t to, unsigned w )
+{
+  /* Helper to interpolate between two pixels, by an 8.8 weight.
+   */
+  unsigned shift; uint32_t result = 0;
+  for( shift = 0; shift < 32; shift += 8 )
+    result |= (uint32_t)((((from >> shift) & 0xFF) * (256 - w)
+	  + ((to >> shift) & 0xFF) * w + 128) >> 8) << shift;
+  return result;
+}
+
+uint32_t wtk_pixel_premultiply( unsigned r, unsigned g, unsigned b, unsigned a )
+{
+  return ((uint32_t)(a) << 24) | (div255( r * a ) << 16) | (div255( g * a ) << 8) | div255( b * a );
+}
+
+/* Scalar implementations; these also process the residual pixels, at the
+ * end of any span, for the SIMD implementations.
+ */
+static void fill_scalar( uint32_t *dst, size_t count, uint32_t colour )
+{
+  while( count-- > 0 ) *dst++ = colour;
+}
+
+static void blend_scalar( uint32_t *dst, const uint32_t *src, size_t count )
+{
+  for( ; count > 0; --count, ++dst, ++src ) *dst = over( *dst, *src );
+}
+
+static void blend_solid_scalar( uint32_t *dst, size_t count, uint32_t colour )
+{
+  for( ; count > 0; --count, ++dst ) *dst = over( *dst, colour );
+}
+
+static void blend_mask_scalar
+( uint32_t *dst, const uint8_t *coverage, size_t count, uint32_t colour )
+{
+  for( ; count > 0; --count, ++dst, ++coverage )
+    if( *coverage ) *dst = over( *dst, scale( colour, *coverage ) );
+}
+
+static void gradient_scalar
+( uint32_t *dst, size_t count, uint32_t from, uint32_t to, int32_t origin, int32_t step )
+{
+  for( ; count > 0; --count, origin += step ) *dst++ = mix( from, to, weight( origin ) );
+}
+
+#ifdef WTK_PIXEL_SIMD
+/* SSE2 implementations, each processing four pixels at a time, with
+ * components unpacked to 16-bit lanes, two pixels per vector.
+ */
+SSE2_TARGET static __inline__ __m128i div255_sse2( __m128i x )
+{
+  x = _mm_add_epi16( x, _mm_set1_epi16( 128 ) );
+  return _mm_srli_epi16( _mm_add_epi16( x, _mm_srli_epi16( x, 8 ) ), 8 );
+}
+
+SSE2_TARGET static __inline__ __m128i alpha_sse2( __m128i x )
+{
+  /* Broadcast the alpha component of each of two unpacked pixels.
+   */
+  return _mm_shufflehi_epi16( _mm_shufflelo_epi16( x, 0xFF ), 0xFF );
+}
+
+SSE2_TARGET static __inline__ __m128i over_sse2( __m128i d, __m128i s )
+{
+  /* Composite four source pixels over four destination pixels.
+   */
+  __m128i zero = _mm_setzero_si128(), ones = _mm_set1_epi16( 255 );
+  __m128i lo = _mm_unpacklo_epi8( d, zero ), hi = _mm_unpackhi_epi8( d, zero );
+  lo = div255_sse2( _mm_mullo_epi16( lo, _mm_sub_epi16( ones, alpha_sse2( _mm_unpacklo_epi8( s, zero ) ))));
+  hi = div255_sse2( _mm_mullo_epi16( hi, _mm_sub_epi16( ones, alpha_sse2( _mm_unpackhi_epi8( s, zero ) ))));
+  return _mm_adds_epu8( s, _mm_packus_epi16( lo, hi ) );
+}
+
+SSE2_TARGET static void fill_sse2( uint32_t *dst, size_t count, uint32_t colour )
+{
+  __m128i value = _mm_set1_epi32( (int)(colour) );
+  for( ; count >= 4; count -= 4, dst += 4 ) _mm_storeu_si128( (__m128i *)(dst), value );
+  fill_scalar( dst, count, colour );
+}
+
+SSE2_TARGET static void blend_sse2( uint32_t *dst, const uint32_t *src, size_t count )
+{
+  for( ; count >= 4; count -= 4, dst += 4, src += 4 )
+    _mm_storeu_si128( (__m128i *)(dst), over_sse2(
+	  _mm_loadu_si128( (const __m128i *)(dst) ), _mm_loadu_si128( (const __m128i *)(src) )
+	));
+  blend_scalar( dst, src, count );
+}
+
+SSE2_TARGET static void blend_solid_sse2( uint32_t *dst, size_t count, uint32_t colour )
+{
+  __m128i s = _mm_set1_epi32( (int)(colour) );
+  for( ; count >= 4; count -= 4, dst += 4 )
+    _mm_storeu_si128( (__m128i *)(dst), over_sse2( _mm_loadu_si128( (const __m128i *)(dst) ), s ));
+  blend_solid_scalar( dst, count, colour );
+}
+
+SSE2_TARGET static void blend_mask_sse2
+( uint32_t *dst, const uint8_t *coverage, size_t count, uint32_t colour )
+{
+  __m128i zero = _mm_setzero_si128();
+  __m128i s = _mm_unpacklo_epi8( _mm_set1_epi32( (int)(colour) ), zero );
+  for( ; count >= 4; count -= 4, dst += 4, coverage += 4 )
+  {
+    /* Replicate each coverage value across the four components of its
+     * pixel, and scale the source colour by it, before compositing.
+     */
+    int32_t m; __m128i cover;
+    __builtin_memcpy( &m, coverage, sizeof( m ) );
+    if( m == 0 ) continue;
+    cover = _mm_cvtsi32_si128( m );
+    cover = _mm_unpacklo_epi8( cover, cover );
+    cover = _mm_unpacklo_epi16( cover, cover );
+    _mm_storeu_si128( (__m128i *)(dst), over_sse2( _mm_loadu_si128( (const __m128i *)(dst) ),
+	  _mm_packus_epi16(
+	    div255_sse2( _mm_mullo_epi16( s, _mm_unpacklo_epi8( cover, zero ) ) ),
+	    div255_sse2( _mm_mullo_epi16( s, _mm_unpackhi_epi8( cover, zero ) ) )
+	  )));
+  }
+  blend_mask_scalar( dst, coverage, count, colour );
+}
+
+SSE2_TARGET static void gradient_sse2
+( uint32_t *dst, size_t count, uint32_t from, uint32_t to, int32_t origin, int32_t step )
+{
+  __m128i zero = _mm_setzero_si128(), full = _mm_set1_epi16( 256 );
+  __m128i a = _mm_unpacklo_epi8( _mm_set1_epi32( (int)(from) ), zero );
+  __m128i b = _mm_unpacklo_epi8( _mm_set1_epi32( (int)(to) ), zero );
+  __m128i limit = _mm_set1_epi32( 0x10000 ), advance = _mm_set1_epi32( 4 * step );
+  __m128i position = _mm_setr_epi32( origin, origin + step, origin + 2 * step, origin + 3 * step );
+  for( ; count >= 4; count -= 4, dst += 4, origin += 4 * step )
+  {
+    /* Clamp each position to the range 0..0x10000, (without the SSE4.1
+     * min and max instructions), then derive the weights, replicated for
+     * each component of each pixel.
+     */
+    __m128i p = _mm_andnot_si128( _mm_cmplt_epi32( position, zero ), position );
+    __m128i over_limit = _mm_cmpgt_epi32( p, limit ), w, lo, hi;
+    p = _mm_or_si128( _mm_and_si128( over_limit, limit ), _mm_andnot_si128( over_limit, p ) );
+    w = _mm_srli_epi32( p, 8 );
+    w = _mm_packs_epi32( w, w );
+    w = _mm_unpacklo_epi16( w, w );
+    lo = _mm_unpacklo_epi32( w, w ); hi = _mm_unpackhi_epi32( w, w );
+    lo = _mm_srli_epi16( _mm_add_epi16( _mm_add_epi16( _mm_mullo_epi16( a, _mm_sub_epi16( full, lo ) ),
+	    _mm_mullo_epi16( b, lo ) ), _mm_set1_epi16( 128 ) ), 8 );
+    hi = _mm_srli_epi16( _mm_add_epi16( _mm_add_epi16( _mm_mullo_epi16( a, _mm_sub_epi16( full, hi ) ),
+	    _mm_mullo_epi16( b, hi ) ), _mm_set1_epi16( 128 ) ), 8 );
+    _mm_storeu_si128( (__m128i *)(dst), _mm_packus_epi16( lo, hi ) );
+    position = _mm_add_epi32( position, advance );
+  }
+  gradient_scalar( dst, count, from, to, origin, step );
+}
+
+/* AVX2 implementations, each processing eight pixels at a time; (the
+ * unpack and pack operations work within 128-bit lanes, so the pixel order
+ * is preserved, without any need for permutation).
+ */
+AVX2_TARGET static __inline__ __m256i div255_avx2( __m256i x )
+{
+  x = _mm256_add_epi16( x, _mm256_set1_epi16( 128 ) );
+  return _mm256_srli_epi16( _mm256_add_epi16( x, _mm256_srli_epi16( x, 8 ) ), 8 );
+}
+
+AVX2_TARGET static __inline__ __m256i alpha_avx2( __m256i x )
+{
+  return _mm256_shufflehi_epi16( _mm256_shufflelo_epi16( x, 0xFF ), 0xFF );
+}
+
+AVX2_TARGET static __inline__ __m256i over_avx2( __m256i d, __m256i s )
+{
+  __m256i zero = _mm256_setzero_si256(), ones = _mm256_set1_epi16( 255 );
+  __m256i lo = _mm256_unpacklo_epi8( d, zero ), hi = _mm256_unpackhi_epi8( d, zero );
+  lo = div255_avx2( _mm256_mullo_epi16( lo, _mm256_sub_epi16( ones, alpha_avx2( _mm256_unpacklo_epi8( s, zero ) ))));
+  hi = div255_avx2( _mm256_mullo_epi16( hi, _mm256_sub_epi16( ones, alpha_avx2( _mm256_unpackhi_epi8( s, zero ) ))));
+  return _mm256_adds_epu8( s, _mm256_packus_epi16( lo, hi ) );
+}
+
+AVX2_TARGET static void fill_avx2( uint32_t *dst, size_t count, uint32_t colour )
+{
+  __m256i value = _mm256_set1_epi32( (int)(colour) );
+  for( ; count >= 8; count -= 8, dst += 8 ) _mm256_storeu_si256( (__m256i *)(dst), value );
+  fill_scalar( dst, count, colour );
+}
+
+AVX2_TARGET static void blend_avx2( uint32_t *dst, const uint32_t *src, size_t count )
+{
+  for( ; count >= 8; count -= 8, dst += 8, src += 8 )
+    _mm256_storeu_si256( (__m256i *)(dst), over_avx2(
+	  _mm256_loadu_si256( (const __m256i *)(dst) ), _mm256_loadu_si256( (const __m256i *)(src) )
+	));
+  blend_scalar( dst, src, count );
+}
+
+AVX2_TARGET static void blend_solid_avx2( uint32_t *dst, size_t count, uint32_t colour )
+{
+  __m256i s = _mm256_set1_epi32( (int)(colour) );
+  for( ; count >= 8; count -= 8, dst += 8 )
+    _mm256_storeu_si256( (__m256i *)(dst), over_avx2( _mm256_loadu_si256( (const __m256i *)(dst) ), s ));
+  blend_solid_scalar( dst, count, colour );
+}
+
+AVX2_TARGET static void blend_mask_avx2
+( uint32_t *dst, const uint8_t *coverage, size_t count, uint32_t colour )
+{
+  __m256i zero = _mm256_setzero_si256();
+  __m256i s = _mm256_unpacklo_epi8( _mm256_set1_epi32( (int)(colour) ), zero );
+  for( ; count >= 8; count -= 8, dst += 8, coverage += 8 )
+  {
+    int64_t m; __m128i x; __m256i cover;
+    __builtin_memcpy( &m, coverage, sizeof( m ) );
+    if( m == 0 ) continue;
+    x = _mm_loadl_epi64( (const __m128i *)(coverage) );
+    x = _mm_unpacklo_epi8( x, x );
+    cover = _mm256_inserti128_si256( _mm256_castsi128_si256(
+	  _mm_unpacklo_epi16( x, x ) ), _mm_unpackhi_epi16( x, x ), 1
+	);
+    _mm256_storeu_si256( (__m256i *)(dst), over_avx2( _mm256_loadu_si256( (const __m256i *)(dst) ),
+	  _mm256_packus_epi16(
+	    div255_avx2( _mm256_mullo_epi16( s, _mm256_unpacklo_epi8( cover, zero ) ) ),
+	    div255_avx2( _mm256_mullo_epi16( s, _mm256_unpackhi_epi8( cover, zero ) ) )
+	  )));
+  }
+  blend_mask_scalar( dst, coverage, count, colour );
+}
+
+AVX2_TARGET static void gradient_avx2
+( uint32_t *dst, size_t count, uint32_t from, uint32_t to, int32_t origin, int32_t step )
+{
+  __m256i zero = _mm256_setzero_si256(), full = _mm256_set1_epi16( 256 );
+  __m256i a = _mm256_unpacklo_epi8( _mm256_set1_epi32( (int)(from) ), zero );
+  __m256i b = _mm256_unpacklo_epi8( _mm256_set1_epi32( (int)(to) ), zero );
+  __m256i limit = _mm256_set1_epi32( 0x10000 ), advance = _mm256_set1_epi32( 8 * step );
+  __m256i position = _mm256_add_epi32( _mm256_set1_epi32( origin ),
+      _mm256_mullo_epi32( _mm256_set1_epi32( step ), _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 ) )
+    );
+  for( ; count >= 8; count -= 8, dst += 8, origin += 8 * step )
+  {
+    __m256i w = _mm256_srli_epi32( _mm256_min_epi32( _mm256_max_epi32( position, zero ), limit ), 8 );
+    __m256i lo, hi;
+    w = _mm256_packs_epi32( w, w );
+    w = _mm256_unpacklo_epi16( w, w );
+    lo = _mm256_unpacklo_epi32( w, w ); hi = _mm256_unpackhi_epi32( w, w );
+    lo = _mm256_srli_epi16( _mm256_add_epi16( _mm256_add_epi16(
+	    _mm256_mullo_epi16( a, _mm256_sub_epi16( full, lo ) ), _mm256_mullo_epi16( b, lo )
+	  ), _mm256_set1_epi16( 128 ) ), 8 );
+    hi = _mm256_srli_epi16( _mm256_add_epi16( _mm256_add_epi16(
+	    _mm256_mullo_epi16( a, _mm256_sub_epi16( full, hi ) ), _mm256_mullo_epi16( b, hi )
+	  ), _mm256_set1_epi16( 128 ) ), 8 );
+    _mm256_storeu_si256( (__m256i *)(dst), _mm256_packus_epi16( lo, hi ) );
+    position = _mm256_add_epi32( position, advance );
+  }
+  gradient_scalar( dst, count, from, to, origin, step );
+}
+#endif
+
+/* The dispatch table, with one entry for each implementation; the
+ * selected entry is established on first use.
+ */
+static const struct pixel_kernels
+{
+  void (*fill)( uint32_t *, size_t, uint32_t );
+  void (*blend)( uint32_t *, const uint32_t *, size_t );
+  void (*blend_solid)( uint32_t *, size_t, uint32_t );
+  void (*blend_mask)( uint32_t *, const uint8_t *, size_t, uint32_t );
+  void (*gradient)( uint32_t *, size_t, uint32_t, uint32_t, int32_t, int32_t );
+} kernels[] =
+{ { fill_scalar, blend_scalar, blend_solid_scalar, blend_mask_scalar, gradient_scalar }
+#ifdef WTK_PIXEL_SIMD
+, { fill_sse2, blend_sse2, blend_solid_sse2, blend_mask_sse2, gradient_sse2 }
+, { fill_avx2, blend_avx2, blend_solid_avx2, blend_mask_avx2, gradient_avx2 }
+#endif
+};
+
+static const struct pixel_kernels *selected = NULL;
+
+static int supported( int implementation )
+{
+  /* Helper to determine whether the processor supports a specified
+   * implementation.
+   */
+  switch( implementation )
+  {
+    case WTK_PIXEL_SCALAR: return 1;
+#  ifdef WTK_PIXEL_SIMD
+    case WTK_PIXEL_SSE2: __builtin_cpu_init(); return __builtin_cpu_supports( "sse2" );
+    case WTK_PIXEL_AVX2: __builtin_cpu_init(); return __builtin_cpu_supports( "avx2" );
+#  endif
+  }
+  return 0;
+}
+
+int wtk_pixel_select( int implementation )
+{
+  if( supported( implementation ) ) selected = kernels + implementation;
+  return wtk_pixel_implementation();
+}
+
+int wtk_pixel_implementation( void )
+{
+  /* Identify the selected implementation, choosing the most capable
+   * which is supported, if none has yet been selected.
+   */
+  if( selected == NULL )
+  {
+    int implementation = WTK_PIXEL_AVX2;
+    while( ! supported( implementation ) ) --implementation;
+    selected = kernels + implementation;
+  }
+  return selected - kernels;
+}
+
+/* The public entry points, each of which simply delegates to the
+ * selected implementation.
+ */
+void wtk_pixel_fill( uint32_t *dst, size_t count, uint32_t colour )
+{
+  kernels[wtk_pixel_implementation()].fill( dst, count, colour );
+}
+
+void wtk_pixel_blend( uint32_t *dst, const uint32_t *src, size_t count )
+{
+  kernels[wtk_pixel_implementation()].blend( dst, src, count );
+}
+
+void wtk_pixel_blend_solid( uint32_t *dst, size_t count, uint32_t colour )
+{
+  kernels[wtk_pixel_implementation()].blend_solid( dst, count, colour );
+}
+
+void wtk_pixel_blend_mask
+( uint32_t *dst, const uint8_t *coverage, size_t count, uint32_t colour )
+{
+  kernels[wtk_pixel_implementation()].blend_mask( dst, coverage, count, colour );
+}
+
+void wtk_pixel_gradient
+( uint32_t *dst, size_t count, uint32_t from, uint32_t to, int32_t origin, int32_t step )
+{
+  kernels[wtk_pixel_implementation()].gradient( dst, count, from, to, origin, step );
+}
+
+/* $RCSfile$: end of file */
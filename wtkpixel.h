@@ -0,0 +1,100 @@
+#ifndef WTKPIXEL_H
+/*
+ * wtkpixel.h
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This header file declares the pixel processing kernels, which operate on
+ * spans of 32-bit premultiplied alpha pixels, as used by the Canvas class;
+ * they are pure memory operations, written in C, with no dependency on the
+ * MS-Windows API.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WTKPIXEL_H  1
+
+/* Pixels are 32-bit values, in the layout of a 32-bpp DIB section, (i.e.
+ * 0xAARRGGBB), with colour components premultiplied by alpha; each kernel
+ * processes a single contiguous span.  Where the compiler supports it, and
+ * the processor is found to implement it, each kernel is dispatched to an
+ * AVX2 or SSE2 implementation, otherwise to a scalar fallback; all produce
+ * identical results.
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include "wtkdefs.h"
+
+BEGIN_NAMESPACE( WTK )
+
+/* Build a premultiplied pixel value, from straight alpha components.
+ */
+EXTERN_C uint32_t wtk_pixel_premultiply( unsigned r, unsigned g, unsigned b, unsigned a );
+
+/* Set every pixel in a span to a specified value.
+ */
+EXTERN_C void wtk_pixel_fill( uint32_t *dst, size_t count, uint32_t colour );
+
+/* Composite a span of source pixels, or a single source colour, (which
+ * may be scaled by a span of 8-bit coverage values), over a span of
+ * destination pixels, using the Porter-Duff "over" operator.
+ */
+EXTERN_C void wtk_pixel_blend( uint32_t *dst, const uint32_t *src, size_t count );
+EXTERN_C void wtk_pixel_blend_solid( uint32_t *dst, size_t count, uint32_t colour );
+EXTERN_C void wtk_pixel_blend_mask
+( uint32_t *dst, const uint8_t *coverage, size_t count, uint32_t colour );
+
+/* Fill a span with a linear gradient, between two colours; the position
+ * of each pixel within the gradient is given in 16.16 fixed point, (where
+ * 0x10000 represents the final colour), starting at "origin", and advancing
+ * by "step" per pixel.
+ */
+EXTERN_C void wtk_pixel_gradient
+( uint32_t *dst, size_t count, uint32_t from, uint32_t to, int32_t origin, int32_t step );
+
+/* Identify the implementation selected for the current processor, as one
+ * of the following.
+ */
+#define WTK_PIXEL_SCALAR	0
+#define WTK_PIXEL_SSE2		1
+#define WTK_PIXEL_AVX2		2
+
+EXTERN_C int wtk_pixel_implementation( void );
+
+/* Override the selection, (e.g. to compare implementations); requests
+ * for an implementation which is not supported are ignored.  Returns the
+ * implementation actually selected.
+ */
+EXTERN_C int wtk_pixel_select( int );
+
+END_NAMESPACE( WTK )
+
+#endif /* WTKPIXEL_H: $RCSfile$: end of file */
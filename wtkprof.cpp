@@ -0,0 +1,226 @@
+/*
+ * wtkprof.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation for the WTK::StartupProfiler
+ * class, which records a high resolution timeline of the start-up phases
+ * of an application, and writes it out in either Chrome trace JSON, or a
+ * compact binary format.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <stdio.h>
+#include <string.h>
+#include "wtklite.h"
+
+namespace WTK
+{
+  /* Each recorded event comprises a performance counter time stamp,
+   * the identity of the thread which recorded it, its phase type, and
+   * a reference to its (static) name; the name is stored last, so that
+   * a record which is still incomplete may be identified, and skipped,
+   * if the timeline is written out while it is being recorded.
+   */
+  struct TraceEvent
+  {
+    LONGLONG ticks;
+    DWORD thread;
+    char phase;
+    const char * volatile name;
+  };
+
+  static TraceEvent trace[WTK_TRACE_EVENTS_MAX];
+  static volatile LONG trace_count = 0;
+  static LONGLONG trace_origin, trace_frequency;
+  static char *trace_file = NULL;
+  static int trace_format = WTK_TRACE_JSON;
+
+  volatile bool StartupProfiler::Active = false;
+
+  void StartupProfiler::Record( char phase, const char *name )
+  {
+    /* Append an event to the timeline; each thread reserves its own
+     * slot, so no locking is required, but events are discarded when
+     * all slots have been used.
+     */
+    LONG slot = InterlockedIncrement( &trace_count ) - 1;
+    if( (slot < WTK_TRACE_EVENTS_MAX) && (name != NULL) )
+    {
+      LARGE_INTEGER now; QueryPerformanceCounter( &now );
+      trace[slot].ticks = now.QuadPart - trace_origin;
+      trace[slot].thread = GetCurrentThreadId();
+      trace[slot].phase = phase;
+      trace[slot].name = name;
+    }
+  }
+
+  void StartupProfiler::Enable( const char *filename, int format )
+  {
+    /* Activate the profiler, recording the file name, and format, for
+     * eventual output; the profiler's time origin is established when
+     * the program is loaded, (see profiler_init below), so that phases
+     * preceding this activation are not misrepresented.
+     */
+    if( filename != NULL )
+    {
+      free( (void *)(trace_file) );
+      if( (trace_file = strdup( filename )) != NULL )
+      {
+	/* On first activation, the timeline is anchored by an event
+	 * representing process creation, at the time origin.
+	 */
+	if( InterlockedCompareExchange( &trace_count, 1, 0 ) == 0 )
+	{
+	  trace[0].ticks = 0LL; trace[0].phase = 'i';
+	  trace[0].thread = GetCurrentThreadId();
+	  trace[0].name = "process created";
+	}
+	trace_format = format;
+	Active = true;
+      }
+    }
+  }
+
+  static void json_escape( FILE *out, const char *name )
+  {
+    /* Local helper, to write an event name as a JSON string.
+     */
+    fputc( '"', out );
+    for( ; *name; ++name )
+    {
+      if( (*name == '"') || (*name == '\\') ) fputc( '\\', out );
+      if( (unsigned char)(*name) >= ' ' ) fputc( *name, out );
+    }
+    fputc( '"', out );
+  }
+
+  void StartupProfiler::Complete()
+  {
+    /* Deactivate the profiler, and write out the recorded timeline.
+     */
+    if( ! Active ) return;
+    Active = false;
+
+    FILE *out = fopen( trace_file, (trace_format == WTK_TRACE_JSON) ? "w" : "wb" );
+    if( out != NULL )
+    {
+      LONG count = trace_count;
+      if( count > WTK_TRACE_EVENTS_MAX ) count = WTK_TRACE_EVENTS_MAX;
+      if( trace_format == WTK_TRACE_JSON )
+      {
+	/* Generate Chrome trace JSON, with time stamps in microseconds;
+	 * we use double precision, to avoid overflow in the conversion
+	 * from performance counter ticks.
+	 */
+	const char *separator = "";
+	fputs( "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", out );
+	for( LONG i = 0; i < count; i++ ) if( trace[i].name != NULL )
+	{
+	  fprintf( out, "%s\n{\"name\":", separator ); json_escape( out, trace[i].name );
+	  fprintf( out, ",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%lu,\"tid\":%lu%s}",
+	      trace[i].phase, 1.0e6 * (double)(trace[i].ticks) / trace_frequency,
+	      (unsigned long)(GetCurrentProcessId()), (unsigned long)(trace[i].thread),
+	      (trace[i].phase == 'i') ? ",\"s\":\"p\"" : ""
+	    );
+	  separator = ",";
+	}
+	fputs( "\n]}\n", out );
+      }
+      else
+      {
+	/* Generate the compact binary format, as described in wtkprof.h
+	 */
+	DWORD header[2] = { WTK_TRACE_VERSION, 0 };
+	for( LONG i = 0; i < count; i++ ) if( trace[i].name != NULL ) ++header[1];
+	fwrite( "WTKTRACE", 8, 1, out ); fwrite( header, sizeof( header ), 1, out );
+	fwrite( &trace_frequency, sizeof( trace_frequency ), 1, out );
+	for( LONG i = 0; i < count; i++ ) if( trace[i].name != NULL )
+	{
+	  size_t len = strlen( trace[i].name ); if( len > 255 ) len = 255;
+	  unsigned char tag[2] = { (unsigned char)(trace[i].phase), (unsigned char)(len) };
+	  fwrite( &trace[i].ticks, sizeof( LONGLONG ), 1, out );
+	  fwrite( &trace[i].thread, sizeof( DWORD ), 1, out );
+	  fwrite( tag, sizeof( tag ), 1, out ); fwrite( trace[i].name, len, 1, out );
+	}
+      }
+      fclose( out );
+    }
+  }
+
+  static class StartupProfilerInitialiser
+  {
+    /* A static object, whose constructor runs during program loading,
+     * to establish the time origin for the profiler.  We would like this
+     * to coincide with process creation; we cannot read the performance
+     * counter at that time, but we may deduce its equivalent, from the
+     * elapsed system time since the process was created.
+     */
+    public:
+      StartupProfilerInitialiser()
+      {
+	LARGE_INTEGER now, freq;
+	QueryPerformanceCounter( &now ); QueryPerformanceFrequency( &freq );
+	trace_frequency = freq.QuadPart; trace_origin = now.QuadPart;
+
+	FILETIME created, unused, system;
+	if( GetProcessTimes( GetCurrentProcess(), &created, &unused, &unused, &unused ) )
+	{
+	  /* Both FILETIME values are expressed in units of 100ns; adjust
+	   * the origin backwards, by the interval between them.
+	   */
+	  GetSystemTimeAsFileTime( &system );
+	  LONGLONG elapsed = ((LONGLONG)(system.dwHighDateTime) << 32) + system.dwLowDateTime
+	    - ((LONGLONG)(created.dwHighDateTime) << 32) - created.dwLowDateTime;
+	  if( elapsed > 0 ) trace_origin -= (LONGLONG)((double)(elapsed) * trace_frequency / 1.0e7);
+	}
+
+	/* Activate the profiler, if requested by the environment, and
+	 * record the time at which the program was loaded.
+	 */
+	char filename[MAX_PATH];
+	DWORD len = GetEnvironmentVariable( "WTK_STARTUP_TRACE", filename, MAX_PATH );
+	if( (len > 0) && (len < MAX_PATH) )
+	{
+	  StartupProfiler::Enable( filename,
+	      ((len > 4) && (stricmp( filename + len - 4, ".bin" ) == 0))
+	      ? WTK_TRACE_BINARY : WTK_TRACE_JSON
+	    );
+	  StartupProfiler::Mark( "program loaded" );
+	}
+      }
+  } profiler_init;
+}
+
+/* $RCSfile$: end of file */
@@ -0,0 +1,120 @@
+#ifndef WTKPROF_H
+/*
+ * wtkprof.h
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This header file declares the WTK::StartupProfiler class, and its
+ * WTK::StartupPhase helper, which may be used to record a timeline of
+ * the phases of application start-up, from process creation until the
+ * first window paint.  It is implicitly included when including wtklite.h.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WTKPROF_H  1
+
+/* Identify the output formats which the profiler may generate; the
+ * JSON format is suitable for loading into the Chrome trace viewer,
+ * (chrome://tracing), while the binary format is compact, and is more
+ * suitable for automated comparison between releases:--
+ *
+ *   char magic[8] = "WTKTRACE"; DWORD version; DWORD count;
+ *   LONGLONG ticks_per_second;
+ *
+ * followed by "count" records, each of which comprises:--
+ *
+ *   LONGLONG ticks; DWORD thread_id; BYTE phase; BYTE length;
+ *   char name[length];
+ *
+ * where "ticks" is measured from process creation, and "phase" is one
+ * of the ASCII characters 'B', 'E' or 'i', (as in the JSON format), to
+ * represent the beginning or end of a phase, or an instantaneous event.
+ */
+#define WTK_TRACE_JSON		0
+#define WTK_TRACE_BINARY	1
+#define WTK_TRACE_VERSION	1
+
+/* The maximum number of events which may be recorded.
+ */
+#define WTK_TRACE_EVENTS_MAX	1024
+
+#ifdef __cplusplus
+
+namespace WTK
+{
+  class StartupProfiler
+  {
+    /* A static class to record the timeline of application start-up.
+     * It is disabled by default, but may be enabled, either by a call
+     * to Enable(), or by setting the WTK_STARTUP_TRACE environment
+     * variable to the name of the output file, (the binary format is
+     * selected if this name ends in ".bin"); when disabled, each of the
+     * recording methods costs no more than a test of a static flag.
+     *
+     * The framework records phases for window class construction and
+     * registration, string resource retrieval, and window creation, in
+     * addition to the first OnPaint() call, after which the timeline is
+     * written out, and the profiler is disabled; applications may also
+     * record their own phases, or call Complete() explicitly.
+     */
+    public:
+      static void Enable( const char *, int = WTK_TRACE_JSON );
+      static bool Enabled(){ return Active; }
+
+      static void Begin( const char *name ){ if( Active ) Record( 'B', name ); }
+      static void End( const char *name ){ if( Active ) Record( 'E', name ); }
+      static void Mark( const char *name ){ if( Active ) Record( 'i', name ); }
+      static void Complete();
+
+    private:
+      static void Record( char, const char * );
+      static volatile bool Active;
+  };
+
+  class StartupPhase
+  {
+    /* A helper class, to record a start-up phase which is coincident
+     * with the lifetime of an automatic object; the name is NOT copied,
+     * so it should normally be a string literal.
+     */
+    public:
+      StartupPhase( const char *name ): phase( StartupProfiler::Enabled() ? name : NULL )
+      { if( phase != NULL ) StartupProfiler::Begin( phase ); }
+      ~StartupPhase(){ if( phase != NULL ) StartupProfiler::End( phase ); }
+
+    private:
+      const char *phase;
+  };
+}
+
+#endif /* __cplusplus */
+#endif /* ! WTKPROF_H: $RCSfile$: end of file */
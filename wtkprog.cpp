@@ -0,0 +1,156 @@
+/*
+ * wtkprog.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation of the ProgressChannel class, through
+ * which worker threads report progress, without locks, to be sampled by the
+ * user interface thread at a limited rate.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <string.h>
+#include "wtklite.h"
+#include <commctrl.h>
+
+namespace WTK
+{
+  ProgressChannel::ProgressChannel( unsigned int rate ):
+  Done( 0 ), Total( 0 ), Stamp( 0 ), Period( 1000 / (rate ? rate : 30) ),
+  ShownStamp( 0 ), Bar( NULL, PBM_SETPOS ), Caption( NULL ),
+  SampleCount( 0 ), UpdateCount( 0 )
+  {
+    /* All status slots are initially empty, and unlocked.
+     */
+    memset( (void *)(Slot), 0, sizeof( Slot ) );
+    if( Period == 0 ) Period = 1;
+  }
+
+  void ProgressChannel::Status( const char *text, unsigned int slot )
+  {
+    /* Update a status text slot, (from any thread); the slot's sequence
+     * number is odd while it is being written, so that the reader may detect,
+     * and discard, any inconsistent copy.  A writer which finds the slot
+     * already claimed, by another writer, yields until it is released.
+     */
+    if( slot >= WTK_PROGRESS_SLOTS ) return;
+    ProgressSlot *ref = Slot + slot; LONG seq;
+    while( (seq = ref->sequence & ~1L),
+	InterlockedCompareExchange( &ref->sequence, seq + 1, seq ) != seq
+      ) Sleep( 0 );
+
+    strncpy( ref->text, text ? text : "", WTK_PROGRESS_TEXT_MAX - 1 );
+    ref->text[WTK_PROGRESS_TEXT_MAX - 1] = '\0';
+    ref->stamp = InterlockedIncrement( &Stamp );
+    InterlockedExchange( &ref->sequence, seq + 2 );
+  }
+
+  void ProgressChannel::Attach( HWND bar, HWND caption )
+  {
+    /* Nominate the progress bar, (whose range is set to match the scale
+     * of the reported progress), and the caption window, (whose existing
+     * text is retained, until the first status report is presented).
+     */
+    if( bar != NULL ) SendMessage( bar, PBM_SETRANGE32, 0, WTK_PROGRESS_SCALE );
+    Bar.Bind( bar );
+    if( caption != NULL )
+    {
+      char text[WTK_PROGRESS_TEXT_MAX];
+      GetWindowText( caption, text, sizeof( text ) );
+      Caption.Set( text );
+    }
+    Caption.Bind( caption );
+  }
+
+  void ProgressChannel::Start( TimerWheel *wheel )
+  {
+    /* Begin sampling the channel, at the configured rate.
+     */
+    wheel->Schedule( this, Period, Period );
+  }
+
+  void ProgressChannel::Stop()
+  {
+    /* Stop sampling the channel, after taking a final sample.
+     */
+    if( IsPending() ) { Cancel(); OnTimer(); }
+  }
+
+  void ProgressChannel::OnTimer()
+  {
+    /* Sample the channel: compute the completed fraction, and retrieve the
+     * most recently updated status text, unless it has already been seen.
+     */
+    ++SampleCount;
+    LONG total = Total, done = Done;
+    int position = (total <= 0) || (done <= 0) ? 0
+      : (done >= total) ? WTK_PROGRESS_SCALE : MulDiv( done, WTK_PROGRESS_SCALE, total );
+
+    int latest = -1; LONG stamp = ShownStamp;
+    for( int i = 0; i < WTK_PROGRESS_SLOTS; i++ )
+      if( (Slot[i].stamp - stamp) > 0 ) stamp = Slot[(latest = i)].stamp;
+
+    const char *text = NULL;
+    for( int retry = 0; (latest >= 0) && (retry < 64); retry++ )
+    {
+      /* Take a consistent copy of the selected slot; if it is being
+       * written, or was written while we copied it, try again, (but only a
+       * few times; if we do not succeed, we will do so on the next sample).
+       */
+      ProgressSlot *ref = Slot + latest;
+      LONG seq = ref->sequence;
+      if( seq & 1L ) continue;
+      MemoryBarrier();
+      memcpy( Sampled, ref->text, sizeof( Sampled ) );
+      stamp = ref->stamp;
+      MemoryBarrier();
+      if( ref->sequence == seq ) { ShownStamp = stamp; text = Sampled; break; }
+    }
+    if( OnProgress( position, text ) ) ++UpdateCount;
+  }
+
+  bool ProgressChannel::OnProgress( int position, const char *text )
+  {
+    /* Present the sampled state, updating the progress bar, and caption,
+     * only when their values have changed.
+     */
+    bool updated = false;
+    if( position != Bar.Get() ) { Bar.Set( position ); updated = true; }
+    if( (text != NULL) && (strcmp( text, Caption.Get() ) != 0) )
+    { Caption.Set( text ); updated = true; }
+    return updated;
+  }
+}
+
+/* $RCSfile$: end of file */
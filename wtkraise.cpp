@@ -10,10 +10,11 @@
  *
  * This file provides the implementation for RaiseAppWindow(), a helper
  * function which checks for any already running instance of the calling
- * application, and promotes any such existing instance to foreground.
+ * application, and promotes any such existing instance to foreground,
+ * and for RaiseWindow(), which performs the promotion.
  *
  * Written by Keith Marshall <keithmarshall@users.sourceforge.net>
- * Copyright (C) 2013, 2014, MinGW.org Project.
+ * Copyright (C) 2013, 2014, 2026, MinGW.org Project.
  *
  * ---------------------------------------------------------------------------
  *
@@ -48,9 +49,15 @@ namespace WTK
     /* Helper to search for any running instance of a specified window
      * class; when one is found, activate it, and bring to foreground.
      */
-    HWND AppWindow = FindWindow(
-	StringResource( Instance, ClassID ), NULL
-      );
+    return RaiseWindow( FindWindow( StringResource( Instance, ClassID ), NULL ));
+  }
+
+  EXTERN_C int RaiseWindow( HWND AppWindow )
+  {
+    /* Helper to activate a specified application window, (typically
+     * that of some other running process), and bring it to foreground;
+     * first, we check that the window exists...
+     */
     if( (AppWindow != NULL) && IsWindow( AppWindow ) )
     {
       /* ...and when one is, we identify its active window...
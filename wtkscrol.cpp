@@ -0,0 +1,250 @@
+/*
+ * wtkscrol.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation for the ScrollHelper class, which
+ * manages the scroll offset of a window, coalescing scroll requests into at
+ * most one ScrollWindowEx() operation per frame, with optional easing.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <limits.h>
+#include "wtklite.h"
+
+/* Older versions of winuser.h may not define the wheel setting which
+ * selects scrolling by whole pages.
+ */
+#ifndef WHEEL_PAGESCROLL
+#define WHEEL_PAGESCROLL  UINT_MAX
+#endif
+
+namespace WTK
+{
+  ScrollHelper::ScrollHelper( bool kinetic ):
+  Window( NULL ), Kinetic( kinetic ), FramePending( false ), WheelRemainder( 0 )
+  {
+    for( int axis = 0; axis < 2; axis++ )
+    {
+      Unit[axis] = 1; View[axis] = 0;
+      Extent[axis] = Offset[axis] = Target[axis] = 0;
+    }
+  }
+
+  void ScrollHelper::Attach( HWND window )
+  {
+    /* Nominate the window whose content is to be scrolled.
+     */
+    Window = window;
+    Update( SB_HORZ ); Update( SB_VERT );
+  }
+
+  void ScrollHelper::SetUnit( int width, int height )
+  {
+    /* Specify the size, in pixels, of one horizontal, and one vertical,
+     * scroll unit.
+     */
+    Unit[0] = (width > 0) ? width : 1;
+    Unit[1] = (height > 0) ? height : 1;
+    Update( SB_HORZ ); Update( SB_VERT );
+  }
+
+  void ScrollHelper::SetExtent( long width, long height )
+  {
+    /* Specify the extent of the scrollable content, in units; (either
+     * dimension may be zero, for a window which scrolls only in the other).
+     */
+    Extent[0] = width; Extent[1] = height;
+    ScrollTo( Target[0], Target[1] );
+    Update( SB_HORZ ); Update( SB_VERT );
+  }
+
+  void ScrollHelper::SetView( int width, int height )
+  {
+    /* Specify the size, in pixels, of the window's client area.
+     */
+    View[0] = width; View[1] = height;
+    ScrollTo( Target[0], Target[1] );
+    Update( SB_HORZ ); Update( SB_VERT );
+  }
+
+  long ScrollHelper::Clamp( int axis, long offset )
+  {
+    /* Helper to constrain an offset, on a specified axis, such that the
+     * view never extends beyond the end of the content.
+     */
+    long limit = Extent[axis] - View[axis] / Unit[axis];
+    if( offset > limit ) offset = limit;
+    return (offset > 0) ? offset : 0;
+  }
+
+  void ScrollHelper::Update( int bar )
+  {
+    /* Helper to update one scroll bar, to reflect the extent of the
+     * content, the size of the view, and the target offset.
+     */
+    if( Window != NULL )
+    {
+      int axis = (bar == SB_HORZ) ? 0 : 1;
+      SCROLLINFO info;
+      info.cbSize = sizeof( info );
+      info.fMask = SIF_RANGE | SIF_PAGE | SIF_POS;
+      info.nMin = 0; info.nMax = Extent[axis] - 1;
+      info.nPage = View[axis] / Unit[axis]; info.nPos = Target[axis];
+      SetScrollInfo( Window, bar, &info, TRUE );
+    }
+  }
+
+  void ScrollHelper::Schedule()
+  {
+    /* Helper to ensure that a frame is pending, whenever the target
+     * offset differs from the current offset; all requests made before
+     * that frame is due are merged into its single update.
+     */
+    if( ! FramePending && (Window != NULL)
+    &&  ((Target[0] != Offset[0]) || (Target[1] != Offset[1]))  )
+      FramePending = SetTimer( Window, WTK_SCROLL_TIMER, WTK_SCROLL_FRAME, NULL ) != 0;
+  }
+
+  void ScrollHelper::ScrollTo( long x, long y )
+  {
+    /* Set the target offset, and schedule movement towards it.
+     */
+    Target[0] = Clamp( 0, x ); Target[1] = Clamp( 1, y );
+    Schedule();
+  }
+
+  void ScrollHelper::ScrollBy( long dx, long dy )
+  {
+    /* Adjust the target offset, relative to its current value.
+     */
+    ScrollTo( Target[0] + dx, Target[1] + dy );
+    Update( SB_HORZ ); Update( SB_VERT );
+  }
+
+  long ScrollHelper::OnScroll( int bar, int code )
+  {
+    /* Interpret scroll bar actions, on either axis; for thumb tracking,
+     * the 16-bit position which accompanies the message is inadequate for
+     * large extents, so the full tracking position is retrieved from the
+     * scroll bar itself.
+     */
+    int axis = (bar == SB_HORZ) ? 0 : 1;
+    long offset = Target[axis], page = View[axis] / Unit[axis];
+    switch( code )
+    {
+      case SB_LINEUP:	--offset; break;
+      case SB_LINEDOWN:	++offset; break;
+      case SB_PAGEUP:	offset -= page ? page : 1; break;
+      case SB_PAGEDOWN:	offset += page ? page : 1; break;
+      case SB_TOP:	offset = 0; break;
+      case SB_BOTTOM:	offset = Extent[axis]; break;
+
+      case SB_THUMBTRACK:
+      case SB_THUMBPOSITION:
+	{ SCROLLINFO info;
+	  info.cbSize = sizeof( info ); info.fMask = SIF_TRACKPOS;
+	  GetScrollInfo( Window, bar, &info );
+	  offset = info.nTrackPos;
+	}
+	break;
+
+      default:
+	return 0L;
+    }
+    if( axis == 0 ) ScrollTo( offset, Target[1] );
+    else ScrollTo( Target[0], offset );
+    Update( bar );
+    return 0L;
+  }
+
+  long ScrollHelper::OnMouseWheel( WPARAM w_param )
+  {
+    /* Scroll vertically, by the number of units per wheel notch which
+     * the user has configured, (or by a page, if so configured).  High
+     * resolution wheels, and touch pads, report fractions of a notch; any
+     * fraction of a unit which remains is carried forward, to accumulate
+     * with subsequent reports in the same direction.
+     */
+    UINT lines = 3;
+    SystemParametersInfo( SPI_GETWHEELSCROLLLINES, 0, &lines, 0 );
+    long page = View[1] / Unit[1];
+    if( (lines == WHEEL_PAGESCROLL) || ((long)(lines) > page) ) lines = page ? page : 1;
+    long delta = -GET_WHEEL_DELTA_WPARAM( w_param ) * (long)(lines);
+    if( (delta < 0) != (WheelRemainder < 0) ) WheelRemainder = 0;
+    long units = (WheelRemainder += delta) / WHEEL_DELTA;
+    WheelRemainder -= units * WHEEL_DELTA;
+    if( units != 0 ) ScrollBy( 0, units );
+    return 0L;
+  }
+
+  long ScrollHelper::OnTimer( WPARAM id )
+  {
+    /* Once per frame, move the content towards the target offset; with
+     * kinetic scrolling, each frame covers a fixed fraction of the distance
+     * remaining, so that movement decelerates smoothly, otherwise the target
+     * is reached in a single frame.
+     */
+    if( id != WTK_SCROLL_TIMER ) return 1L;
+
+    long step[2];
+    for( int axis = 0; axis < 2; axis++ )
+    {
+      step[axis] = Target[axis] - Offset[axis];
+      if( Kinetic && ((step[axis] > 1) || (step[axis] < -1)) )
+      {
+	long eased = step[axis] / 4;
+	step[axis] = eased ? eased : (step[axis] > 0) ? 1 : -1;
+      }
+      Offset[axis] += step[axis];
+    }
+    /* Move the existing pixels, invalidating only the exposed strips;
+     * when the movement exceeds the view, there is nothing to retain.
+     */
+    long dx = step[0] * Unit[0], dy = step[1] * Unit[1];
+    if( (labs( dx ) < View[0]) && (labs( dy ) < View[1]) )
+      ScrollWindowEx( Window, -dx, -dy, NULL, NULL, NULL, NULL, SW_INVALIDATE | SW_ERASE );
+    else InvalidateRect( Window, NULL, TRUE );
+    UpdateWindow( Window );
+
+    if( (Offset[0] == Target[0]) && (Offset[1] == Target[1]) )
+    {
+      KillTimer( Window, WTK_SCROLL_TIMER );
+      FramePending = false;
+    }
+    return 0L;
+  }
+}
+
+/* $RCSfile$: end of file */
@@ -0,0 +1,418 @@
+/*
+ * wtksrch.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation for the SearchIndex class, which
+ * supports incremental type-ahead searching of a collection of text strings,
+ * using trigram posting lists to confine the candidates for each match.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <ctype.h>
+#include <string.h>
+#include "wtklite.h"
+
+#ifdef __SSE2__
+/* Where the compiler has been directed to generate code for processors
+ * which support the SSE2 instruction set, we use it to verify candidate
+ * matches, sixteen character positions at a time.
+ */
+#include <emmintrin.h>
+#endif
+
+/* Each text string is stored with sufficient padding, beyond its NUL
+ * terminator, to permit reading one full vector beyond any position
+ * within it; a marker denotes unassigned slots in the key map.
+ */
+#define WTK_SEARCH_PADDING  16
+#define WTK_SEARCH_NIL	    (~0U)
+
+namespace WTK
+{
+  struct SearchEntry
+  {
+    /* Each entry records its key, and its text, folded to lower case;
+     * the text pointer is NULL, for an entry which has been removed.
+     */
+    unsigned long key;
+    char *text;
+    size_t length;
+  };
+
+  struct SearchPosting
+  {
+    /* Each posting list records, in ascending order, the index of each
+     * entry containing any trigram with the associated hash.
+     */
+    unsigned int *entry;
+    unsigned int count, size;
+  };
+
+  static inline
+  unsigned int TrigramHash( const char *text )
+  {
+    /* Helper to map the trigram at a specified position, within a text
+     * string, to its posting list bucket.
+     */
+    unsigned long trigram = (unsigned char)(text[0])
+      | ((unsigned char)(text[1]) << 8) | ((unsigned char)(text[2]) << 16);
+    return (unsigned int)((trigram * 2654435761UL) >> 7) & (WTK_SEARCH_BUCKETS - 1);
+  }
+
+  static inline
+  unsigned int KeyHash( unsigned long key )
+  {
+    /* Helper to compute the initial key map probe position for a key.
+     */
+    return (unsigned int)(key * 2654435761UL) ^ (unsigned int)(key >> 16);
+  }
+
+  static char *FoldCase( const char *text, size_t len, size_t padding )
+  {
+    /* Helper to allocate a lower case copy of a text string, with a
+     * specified amount of zero padding beyond its NUL terminator.
+     */
+    char *copy = (char *)(malloc( len + padding + 1 ));
+    if( copy != NULL )
+    {
+      for( size_t i = 0; i < len; i++ ) copy[i] = tolower( (unsigned char)(text[i]) );
+      memset( copy + len, 0, padding + 1 );
+    }
+    return copy;
+  }
+
+  static bool Contains( const char *text, size_t len, const char *pattern, size_t plen )
+  {
+    /* Helper to verify that a candidate text contains a specified pattern.
+     */
+#  ifdef __SSE2__
+    if( (plen > 1) && (len >= plen) )
+    {
+      /* Identify each position at which both the first and the last
+       * characters of the pattern match, in blocks of sixteen positions,
+       * and compare the remaining characters only at such positions.
+       */
+      __m128i first = _mm_set1_epi8( pattern[0] ), last = _mm_set1_epi8( pattern[plen - 1] );
+      for( size_t i = 0; (i + plen) <= len; i += 16 )
+      {
+	__m128i head = _mm_loadu_si128( (const __m128i *)(text + i) );
+	__m128i tail = _mm_loadu_si128( (const __m128i *)(text + i + plen - 1) );
+	unsigned int mask = _mm_movemask_epi8( _mm_and_si128(
+	      _mm_cmpeq_epi8( head, first ), _mm_cmpeq_epi8( tail, last )
+	    ));
+	while( mask != 0 )
+	{
+	  size_t pos = i + __builtin_ctz( mask );
+	  if( ((pos + plen) <= len) && (memcmp( text + pos + 1, pattern + 1, plen - 2 ) == 0) )
+	    return true;
+	  mask &= mask - 1;
+	}
+      }
+      return false;
+    }
+#  endif
+    return (len >= plen) && (strstr( text, pattern ) != NULL);
+  }
+
+  SearchIndex::SearchIndex():
+  Source( NULL ), Entry( NULL ), Posting( NULL ), KeyMap( NULL ), Result( NULL ),
+  EntryCount( 0 ), EntrySize( 0 ), DeadCount( 0 ), KeyMapMask( 0 ),
+  ResultCount( 0 ), ResultSize( 0 ), Pattern( NULL ), Narrowable( false )
+  {
+    /* Allocate the posting list buckets, initially all empty.
+     */
+    Posting = (SearchPosting *)(calloc( WTK_SEARCH_BUCKETS, sizeof( SearchPosting )));
+    if( Posting == NULL ) throw( runtime_error( "Insufficient memory" ) );
+  }
+
+  void SearchIndex::Index( unsigned int entry )
+  {
+    /* Helper to add a specified entry to the posting list associated
+     * with each trigram in its text; (an entry is never added to any one
+     * posting list more than once).
+     */
+    const char *text = Entry[entry].text;
+    for( size_t i = 0; (i + 3) <= Entry[entry].length; i++ )
+    {
+      SearchPosting *list = Posting + TrigramHash( text + i );
+      if( (list->count > 0) && (list->entry[list->count - 1] == entry) )
+	continue;
+      if( list->count == list->size )
+      {
+	unsigned int size = list->size ? list->size << 1 : 4;
+	unsigned int *ref = (unsigned int *)(realloc( list->entry, size * sizeof( unsigned int )));
+	if( ref == NULL ) throw( runtime_error( "Insufficient memory" ) );
+	list->entry = ref; list->size = size;
+      }
+      list->entry[list->count++] = entry;
+    }
+  }
+
+  unsigned int SearchIndex::Lookup( unsigned long key )
+  {
+    /* Helper to locate the live entry, if any, for a specified key.
+     */
+    if( KeyMap != NULL )
+    {
+      unsigned int slot, entry;
+      for( slot = KeyHash( key ) & KeyMapMask; (entry = KeyMap[slot]) != WTK_SEARCH_NIL;
+	  slot = (slot + 1) & KeyMapMask )
+	if( (Entry[entry].key == key) && (Entry[entry].text != NULL) )
+	  return entry;
+    }
+    return WTK_SEARCH_NIL;
+  }
+
+  void SearchIndex::Rehash( unsigned int size )
+  {
+    /* Helper to rebuild the key map, with a specified number of slots,
+     * (a power of two), including only entries which remain live.
+     */
+    unsigned int *map = (unsigned int *)(malloc( size * sizeof( unsigned int )));
+    if( map == NULL ) throw( runtime_error( "Insufficient memory" ) );
+    free( (void *)(KeyMap) ); KeyMap = map; KeyMapMask = size - 1;
+    memset( map, 0xFF, size * sizeof( unsigned int ) );
+    for( unsigned int entry = 0; entry < EntryCount; entry++ )
+      if( Entry[entry].text != NULL )
+      {
+	unsigned int slot = KeyHash( Entry[entry].key ) & KeyMapMask;
+	while( map[slot] != WTK_SEARCH_NIL ) slot = (slot + 1) & KeyMapMask;
+	map[slot] = entry;
+      }
+  }
+
+  void SearchIndex::Add( unsigned long key, const char *text )
+  {
+    /* Add a text string to the index, replacing any which has previously
+     * been added with the same key.
+     */
+    Remove( key );
+    if( EntryCount == EntrySize )
+    {
+      unsigned int size = EntrySize ? EntrySize << 1 : 256;
+      SearchEntry *ref = (SearchEntry *)(realloc( Entry, size * sizeof( SearchEntry )));
+      if( ref == NULL ) throw( runtime_error( "Insufficient memory" ) );
+      Entry = ref; EntrySize = size;
+    }
+    size_t len = strlen( text );
+    if( (Entry[EntryCount].text = FoldCase( text, len, WTK_SEARCH_PADDING )) == NULL )
+      throw( runtime_error( "Insufficient memory" ) );
+    Entry[EntryCount].key = key; Entry[EntryCount].length = len;
+
+    /* The key map is kept no more than half full, (counting slots which
+     * still refer to removed entries).
+     */
+    unsigned int entry = EntryCount++;
+    if( (EntryCount << 1) > KeyMapMask ) Rehash( KeyMapMask ? (KeyMapMask + 1) << 1 : 512 );
+    else
+    {
+      unsigned int slot = KeyHash( key ) & KeyMapMask;
+      while( KeyMap[slot] != WTK_SEARCH_NIL ) slot = (slot + 1) & KeyMapMask;
+      KeyMap[slot] = entry;
+    }
+    Index( entry );
+
+    /* The new entry may match the previous search pattern, so the next
+     * search cannot be confined to the previous result.
+     */
+    Narrowable = false;
+  }
+
+  void SearchIndex::Remove( unsigned long key )
+  {
+    /* Remove the text string associated with a specified key, if any,
+     * from the index, and from the current search result; its posting
+     * list references are retained, until there are sufficiently many
+     * such stale references to justify compaction.
+     */
+    unsigned int entry = Lookup( key );
+    if( entry != WTK_SEARCH_NIL )
+    {
+      free( (void *)(Entry[entry].text) ); Entry[entry].text = NULL;
+      unsigned int lo = 0, hi = ResultCount;
+      while( lo < hi )
+      {
+	unsigned int mid = (lo + hi) >> 1;
+	if( Result[mid] < entry ) lo = mid + 1; else hi = mid;
+      }
+      if( (lo < ResultCount) && (Result[lo] == entry) )
+      {
+	memmove( Result + lo, Result + lo + 1, (--ResultCount - lo) * sizeof( unsigned int ) );
+      }
+      if( (++DeadCount > 1024) && ((DeadCount << 1) > EntryCount) ) Compact();
+    }
+  }
+
+  void SearchIndex::Compact()
+  {
+    /* Helper to discard all removed entries, renumbering those which
+     * remain, and rebuilding the posting lists, key map, and current
+     * result, to reflect the new numbering.
+     */
+    unsigned int *renumber = (unsigned int *)(malloc( EntryCount * sizeof( unsigned int )));
+    if( renumber == NULL ) return;
+
+    unsigned int count = 0;
+    for( unsigned int entry = 0; entry < EntryCount; entry++ )
+      if( Entry[entry].text != NULL )
+      {
+	renumber[entry] = count;
+	Entry[count++] = Entry[entry];
+      }
+    for( unsigned int i = 0; i < ResultCount; i++ ) Result[i] = renumber[Result[i]];
+    free( (void *)(renumber) );
+
+    EntryCount = count; DeadCount = 0;
+    for( unsigned int i = 0; i < WTK_SEARCH_BUCKETS; i++ ) Posting[i].count = 0;
+    for( unsigned int entry = 0; entry < EntryCount; entry++ ) Index( entry );
+    Rehash( KeyMapMask + 1 );
+  }
+
+  unsigned long SearchIndex::Search( const char *pattern )
+  {
+    /* Identify all entries which contain a specified pattern.
+     */
+    size_t plen = strlen( pattern );
+    char *text = FoldCase( pattern, plen, 0 );
+    if( text == NULL ) throw( runtime_error( "Insufficient memory" ) );
+    if( ResultSize < EntryCount )
+    {
+      unsigned int *ref = (unsigned int *)(realloc( Result, EntryCount * sizeof( unsigned int )));
+      if( ref == NULL ) { free( (void *)(text) ); throw( runtime_error( "Insufficient memory" ) ); }
+      Result = ref; ResultSize = EntryCount;
+    }
+
+    /* Choose the set of candidate entries: when the new pattern contains
+     * the previous pattern, (as it usually will, when the user extends
+     * the pattern with each keystroke), only entries which matched the
+     * previous pattern need be considered...
+     */
+    const unsigned int *candidate = NULL;
+    unsigned int count = EntryCount;
+    if( Narrowable && (strstr( text, Pattern ) != NULL) )
+    {
+      candidate = Result; count = ResultCount;
+    }
+    else if( plen >= 3 )
+    {
+      /* ...otherwise, for a pattern of at least three characters, only
+       * those in the shortest posting list for any of its trigrams...
+       */
+      for( size_t i = 0; (i + 3) <= plen; i++ )
+      {
+	SearchPosting *list = Posting + TrigramHash( text + i );
+	if( list->count < count ) { candidate = list->entry; count = list->count; }
+      }
+      if( candidate == NULL ) count = 0;
+    }
+    /* ...and, for shorter patterns, every entry, (when the candidate
+     * list is NULL); candidates are then verified in ascending order,
+     * so the result may safely overwrite the candidate list, when that
+     * is the previous result.
+     */
+    ResultCount = 0;
+    for( unsigned int i = 0; i < count; i++ )
+    {
+      unsigned int entry = candidate ? candidate[i] : i;
+      if( (Entry[entry].text != NULL)
+      &&  Contains( Entry[entry].text, Entry[entry].length, text, plen )  )
+	Result[ResultCount++] = entry;
+    }
+    free( (void *)(Pattern) ); Pattern = text; Narrowable = true;
+    return ResultCount;
+  }
+
+  unsigned long SearchIndex::Match( unsigned long i )
+  {
+    /* Retrieve the key for the i-th entry matched by the most recent
+     * search pattern, (which must be within range).
+     */
+    return Entry[Result[i]].key;
+  }
+
+  void SearchIndex::Attach( VirtualListSource *source, int column )
+  {
+    /* Replace the entire content of the index by the text of a specified
+     * column, for every row of a specified data source, keyed by row
+     * index; the index then presents all rows of that source.
+     */
+    for( unsigned int entry = 0; entry < EntryCount; entry++ )
+      free( (void *)(Entry[entry].text) );
+    for( unsigned int i = 0; i < WTK_SEARCH_BUCKETS; i++ ) Posting[i].count = 0;
+    if( KeyMap != NULL ) memset( KeyMap, 0xFF, (KeyMapMask + 1) * sizeof( unsigned int ) );
+    EntryCount = DeadCount = ResultCount = 0; Narrowable = false;
+
+    char text[WTK_LIST_TEXT_MAX];
+    unsigned long rows = (Source = source)->RowCount();
+    for( unsigned long row = 0; row < rows; row++ )
+    {
+      *text = '\0'; source->FetchText( row, column, text, sizeof( text ) );
+      text[sizeof( text ) - 1] = '\0'; Add( row, text );
+    }
+    Search( "" );
+  }
+
+  unsigned long SearchIndex::RowCount()
+  {
+    /* When presented in a list view, the rows are those which matched
+     * the most recent search pattern.
+     */
+    return ResultCount;
+  }
+
+  void SearchIndex::FetchText( unsigned long row, int column, char *buf, size_t len )
+  {
+    /* Retrieve the text of any cell, in any row which matched the most
+     * recent search pattern, from the attached data source.
+     */
+    if( (row < ResultCount) && (Source != NULL) )
+      Source->FetchText( Entry[Result[row]].key, column, buf, len );
+    else if( len > 0 ) *buf = '\0';
+  }
+
+  SearchIndex::~SearchIndex()
+  {
+    /* Release all storage allocated by the index.
+     */
+    for( unsigned int entry = 0; entry < EntryCount; entry++ )
+      free( (void *)(Entry[entry].text) );
+    for( unsigned int i = 0; i < WTK_SEARCH_BUCKETS; i++ )
+      free( (void *)(Posting[i].entry) );
+    free( (void *)(Posting) ); free( (void *)(Entry) ); free( (void *)(KeyMap) );
+    free( (void *)(Result) ); free( (void *)(Pattern) );
+  }
+}
+
+/* $RCSfile$: end of file */
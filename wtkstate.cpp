@@ -0,0 +1,366 @@
+/*
+ * wtkstate.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation of the StateSnapshot class, which saves
+ * user interface state to a small binary file, on a background thread, and maps
+ * it into memory, for restoration, on the next start up.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <process.h>
+#include "wtklite.h"
+
+/* We refuse to map any snapshot file which is implausibly large.
+ */
+#define WTK_STATE_SIZE_MAX  0x00100000UL
+
+namespace WTK
+{
+  /* Each registered item, and each record in the snapshot file, is of
+   * one of these kinds.
+   */
+  enum { STATE_PLACEMENT = 1, STATE_SASH, STATE_LONG, STATE_DOUBLE };
+
+  struct StateHeader
+  {
+    /* The layout of the snapshot file header; its size includes itself,
+     * and the checksum covers all records which follow it.
+     */
+    uint32_t signature;
+    uint16_t version, count;
+    uint32_t size, checksum;
+  };
+
+  struct StateRecord
+  {
+    /* The layout of each record, of fixed size, in the snapshot file; a
+     * window placement is recorded as flags, show command, minimized and
+     * maximized positions, and normal position rectangle, in that order.
+     */
+    uint32_t key, kind;
+    union { int32_t placement[10]; double real; int32_t integer; } data;
+  };
+
+  struct StateItem
+  {
+    /* A registered item, identified by a hash of its name.
+     */
+    uint32_t key;
+    int kind;
+    void *target;
+  };
+
+  static uint32_t hash( const char *name )
+  {
+    /* Local helper to compute the FNV-1a hash of an item name.
+     */
+    uint32_t value = 2166136261U;
+    while( *name ) value = (value ^ (unsigned char)(*name++)) * 16777619U;
+    return value;
+  }
+
+  static uint32_t checksum( const StateHeader *header )
+  {
+    /* Local helper to compute the checksum of the records which follow
+     * a snapshot header, (also FNV-1a, over their raw content).
+     */
+    const unsigned char *data = (const unsigned char *)(header + 1);
+    size_t size = header->count * sizeof( StateRecord );
+    uint32_t value = 2166136261U;
+    while( size-- > 0 ) value = (value ^ *data++) * 16777619U;
+    return value;
+  }
+
+  StateSnapshot::StateSnapshot( const char *path ):
+  File( INVALID_HANDLE_VALUE ), Mapping( NULL ), Snapshot( NULL ), Item( NULL ),
+  ItemCount( 0 ), ItemSize( 0 ), RestoredShow( SW_HIDE ), Pending( NULL ),
+  Wake( NULL ), Thread( NULL ), Stopping( 0 )
+  {
+    /* Record the file path, and map any existing snapshot which it
+     * identifies; a missing, or invalid, snapshot is simply ignored.
+     */
+    if( (Path = strdup( path )) == NULL ) throw( runtime_error( "Insufficient memory" ) );
+    InitializeCriticalSection( &Lock );
+
+    DWORD size;
+    File = CreateFile( path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+    if( (File != INVALID_HANDLE_VALUE)
+    &&  ((size = GetFileSize( File, NULL )) >= sizeof( StateHeader )) && (size <= WTK_STATE_SIZE_MAX)
+    &&  ((Mapping = CreateFileMapping( File, NULL, PAGE_READONLY, 0, 0, NULL )) != NULL)
+    &&  ((Snapshot = (const StateHeader *)(MapViewOfFile( Mapping, FILE_MAP_READ, 0, 0, 0 ))) != NULL)  )
+    {
+      /* A snapshot has been mapped; discard it, unless its signature,
+       * version, size and checksum are all as expected.
+       */
+      if( (Snapshot->signature != WTK_STATE_SIGNATURE) || (Snapshot->version != WTK_STATE_VERSION)
+      ||  (Snapshot->size != size) || (size != sizeof( StateHeader ) + Snapshot->count * sizeof( StateRecord ))
+      ||  (Snapshot->checksum != checksum( Snapshot ))  ) Release();
+    }
+    else Release();
+  }
+
+  void StateSnapshot::Release()
+  {
+    /* Helper to release the mapped snapshot, (which must be done before
+     * the file can be replaced).
+     */
+    if( Snapshot != NULL ) UnmapViewOfFile( (LPCVOID)(Snapshot) );
+    if( Mapping != NULL ) CloseHandle( Mapping );
+    if( File != INVALID_HANDLE_VALUE ) CloseHandle( File );
+    File = INVALID_HANDLE_VALUE; Mapping = NULL; Snapshot = NULL;
+  }
+
+  void StateSnapshot::Add( const char *name, int kind, void *target )
+  {
+    /* Helper to register an item of any kind.
+     */
+    if( ItemCount == ItemSize )
+    {
+      unsigned int size = ItemSize ? ItemSize << 1 : 16;
+      StateItem *ref = (StateItem *)(realloc( Item, size * sizeof( StateItem ) ));
+      if( ref == NULL ) throw( runtime_error( "Insufficient memory" ) );
+      Item = ref; ItemSize = size;
+    }
+    Item[ItemCount].key = hash( name );
+    Item[ItemCount].kind = kind;
+    Item[ItemCount++].target = target;
+  }
+
+  void StateSnapshot::Register( const char *name, HWND window )
+  { Add( name, STATE_PLACEMENT, (void *)(window) ); }
+
+  void StateSnapshot::Register( const char *name, SashWindowMaker *sash )
+  { Add( name, STATE_SASH, (void *)(sash) ); }
+
+  void StateSnapshot::Register( const char *name, long *value )
+  { Add( name, STATE_LONG, (void *)(value) ); }
+
+  void StateSnapshot::Register( const char *name, double *value )
+  { Add( name, STATE_DOUBLE, (void *)(value) ); }
+
+  bool StateSnapshot::Restore()
+  {
+    /* Apply every recorded value, for which a corresponding item has been
+     * registered, then release the snapshot; returns false, if there was no
+     * valid snapshot to restore.
+     */
+    if( Snapshot == NULL ) return false;
+    const StateRecord *record = (const StateRecord *)(Snapshot + 1);
+    for( unsigned int i = 0; i < ItemCount; i++ )
+      for( unsigned int r = 0; r < Snapshot->count; r++ )
+	if( (record[r].key == Item[i].key) && (record[r].kind == (uint32_t)(Item[i].kind)) )
+	{
+	  switch( Item[i].kind )
+	  {
+	    case STATE_PLACEMENT:
+	      /* A window placement is restored only if its normal position
+	       * lies on a monitor which is still present; the window is not
+	       * shown, if it is not already visible, (but see ShowMode()).
+	       */
+	      WINDOWPLACEMENT placement;
+	      placement.length = sizeof( placement );
+	      memcpy( &placement.flags, record[r].data.placement, sizeof( record[r].data.placement ) );
+	      if( MonitorFromRect( &placement.rcNormalPosition, MONITOR_DEFAULTTONULL ) != NULL )
+	      {
+		HWND window = (HWND)(Item[i].target);
+		RestoredShow = placement.showCmd;
+		if( ! IsWindowVisible( window ) ) placement.showCmd = SW_HIDE;
+		placement.flags = 0;
+		SetWindowPlacement( window, &placement );
+	      }
+	      break;
+
+	    case STATE_SASH:
+	      ((SashWindowMaker *)(Item[i].target))->RestoreDisplacementFactor( record[r].data.real );
+	      break;
+
+	    case STATE_LONG:
+	      *(long *)(Item[i].target) = record[r].data.integer;
+	      break;
+
+	    case STATE_DOUBLE:
+	      *(double *)(Item[i].target) = record[r].data.real;
+	  }
+	  break;
+	}
+    Release();
+    return true;
+  }
+
+  int StateSnapshot::ShowMode( int mode )
+  {
+    /* Substitute a restored maximized state, for any request to show
+     * a window in its normal, or default, state.
+     */
+    if( (RestoredShow == SW_SHOWMAXIMIZED)
+    &&  ((mode == SW_SHOWNORMAL) || (mode == SW_SHOWDEFAULT) || (mode == SW_SHOW)) )
+      return SW_SHOWMAXIMIZED;
+    return mode;
+  }
+
+  void StateSnapshot::Save()
+  {
+    /* Capture the current value of every registered item, then pass the
+     * resultant snapshot to the writer thread, (starting it, if necessary),
+     * superseding any earlier snapshot which it has not yet written.
+     */
+    size_t size = sizeof( StateHeader ) + ItemCount * sizeof( StateRecord );
+    StateHeader *header = (StateHeader *)(calloc( 1, size ));
+    if( header == NULL ) throw( runtime_error( "Insufficient memory" ) );
+    StateRecord *record = (StateRecord *)(header + 1);
+    unsigned int count = 0;
+    for( unsigned int i = 0; i < ItemCount; i++, count++ )
+    {
+      record[count].key = Item[i].key; record[count].kind = Item[i].kind;
+      switch( Item[i].kind )
+      {
+	case STATE_PLACEMENT:
+	  /* A window placement is recorded only for a window which still
+	   * exists; one which is minimized is recorded in the state to which
+	   * it would be restored.
+	   */
+	  WINDOWPLACEMENT placement;
+	  placement.length = sizeof( placement );
+	  if( ! GetWindowPlacement( (HWND)(Item[i].target), &placement ) ) { --count; continue; }
+	  if( placement.showCmd == SW_SHOWMINIMIZED )
+	    placement.showCmd = (placement.flags & WPF_RESTORETOMAXIMIZED) ? SW_SHOWMAXIMIZED : SW_SHOWNORMAL;
+	  else if( placement.showCmd != SW_SHOWMAXIMIZED ) placement.showCmd = SW_SHOWNORMAL;
+	  memcpy( record[count].data.placement, &placement.flags, sizeof( record[count].data.placement ) );
+	  break;
+
+	case STATE_SASH:
+	  record[count].data.real = ((SashWindowMaker *)(Item[i].target))->GetDisplacementFactor();
+	  break;
+
+	case STATE_LONG:
+	  record[count].data.integer = *(long *)(Item[i].target);
+	  break;
+
+	case STATE_DOUBLE:
+	  record[count].data.real = *(double *)(Item[i].target);
+      }
+    }
+    header->signature = WTK_STATE_SIGNATURE;
+    header->version = WTK_STATE_VERSION;
+    header->count = count;
+    header->size = sizeof( StateHeader ) + count * sizeof( StateRecord );
+    header->checksum = checksum( header );
+
+    /* The mapped snapshot, if not already restored, is now obsolete, and
+     * it must be released, so that the file may be replaced.
+     */
+    Release();
+    EnterCriticalSection( &Lock );
+    StateHeader *superseded = Pending; Pending = header;
+    LeaveCriticalSection( &Lock );
+    free( superseded );
+
+    if( (Wake == NULL) && ((Wake = CreateEvent( NULL, FALSE, FALSE, NULL )) == NULL) )
+      throw( runtime_error( "Cannot create state snapshot event" ) );
+    if( (Thread == NULL)
+    &&  ((Thread = (HANDLE)(_beginthreadex( NULL, 0, Writer, this, 0, NULL ))) == NULL)  )
+      throw( runtime_error( "Cannot start state snapshot writer" ) );
+    SetEvent( Wake );
+  }
+
+  unsigned __stdcall StateSnapshot::Writer( void *owner )
+  {
+    /* Thread procedure for the writer; each time it is woken, it writes
+     * whichever snapshot is pending, (if any), until none remains, then it
+     * exits, if the owner is being destroyed.
+     */
+    StateSnapshot *state = (StateSnapshot *)(owner);
+    while( WaitForSingleObject( state->Wake, INFINITE ) == WAIT_OBJECT_0 )
+    {
+      StateHeader *header;
+      do { EnterCriticalSection( &state->Lock );
+	   header = state->Pending; state->Pending = NULL;
+	   LeaveCriticalSection( &state->Lock );
+	   if( header != NULL ) { state->Write( header ); free( header ); }
+	 } while( header != NULL );
+      if( state->Stopping ) break;
+    }
+    return 0;
+  }
+
+  bool StateSnapshot::Write( StateHeader *header )
+  {
+    /* Helper, called on the writer thread, to write a snapshot to a
+     * temporary file, alongside the snapshot file, and then to replace
+     * the snapshot file with it; thus, an interrupted write can never
+     * leave an incomplete snapshot in place.
+     */
+    const char *fmt = "%s.tmp";
+    char tmp[1 + snprintf( NULL, 0, fmt, Path )];
+    snprintf( tmp, sizeof( tmp ), fmt, Path );
+
+    DWORD written = 0;
+    HANDLE file = CreateFile( tmp, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+    if( file == INVALID_HANDLE_VALUE ) return false;
+    bool ok = WriteFile( file, header, header->size, &written, NULL )
+      && (written == header->size) && FlushFileBuffers( file );
+    CloseHandle( file );
+    if( ok && MoveFileEx( tmp, Path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH ) )
+      return true;
+    DeleteFile( tmp );
+    return false;
+  }
+
+  StateSnapshot::~StateSnapshot()
+  {
+    /* Wait for the writer thread to write any pending snapshot, and to
+     * exit, before releasing all resources.
+     */
+    if( Thread != NULL )
+    {
+      InterlockedExchange( &Stopping, 1 );
+      SetEvent( Wake );
+      WaitForSingleObject( Thread, INFINITE );
+      CloseHandle( Thread );
+    }
+    if( Wake != NULL ) CloseHandle( Wake );
+    free( Pending );
+    DeleteCriticalSection( &Lock );
+    Release();
+    free( Item );
+    free( Path );
+  }
+}
+
+/* $RCSfile$: end of file */
@@ -0,0 +1,432 @@
+/*
+ * wtktext.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation for the TextViewWindow class, which
+ * presents a read-only view of a memory mapped text file, while the offsets
+ * of its lines are indexed by a background thread.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <string.h>
+#include <process.h>
+#include "wtklite.h"
+
+#ifdef __SSE2__
+/* Where the compiler has been directed to generate code for processors
+ * which support the SSE2 instruction set, we use it to locate newlines,
+ * sixteen bytes at a time.
+ */
+#include <emmintrin.h>
+#endif
+
+/* Each view mapping extends beyond its nominal chunk, by one unit of
+ * allocation granularity, so that any displayed line which begins within
+ * the chunk is wholly contained within the view.
+ */
+#define WTK_TEXTVIEW_OVERLAP  0x00010000UL
+
+namespace WTK
+{
+  const char *TextViewWindow::ClassName = NULL;
+  const char *TextViewWindow::RegisteredClassName( void )
+  {
+    /* Helper routine to ensure that the appropriate window class
+     * name is registered on first instantiation of any class object,
+     * (by whichever thread first instantiates one).
+     */
+    if( ClassName == NULL )
+    {
+      static volatile LONG lock = 0; SpinLock hold( &lock );
+      if( ClassName == NULL )
+      {
+	WindowClassMaker WindowClassRegistry( AppInstance );
+	WindowClassRegistry.Register( "TextView" ); ClassName = "TextView";
+      }
+    }
+    return ClassName;
+  }
+
+  TextViewWindow::TextViewWindow( HINSTANCE app ): ChildWindowMaker( app ),
+  File( NULL ), Mapping( NULL ), Indexer( NULL ), FileSize( 0 ), Page( NULL ),
+  IndexedLines( 0 ), ProgressPending( 0 ), Indexed( false ), Cancelled( false ),
+  NextView( 0 ), TopLine( 0 ), PageLines( 0 ), ShownLines( 0 ), LineHeight( 0 ),
+  Font( (HFONT)(GetStockObject( ANSI_FIXED_FONT )) )
+  {
+    for( int i = 0; i < WTK_TEXTVIEW_VIEWS; i++ ) View[i].data = NULL;
+  }
+
+  HWND TextViewWindow::Create( int id, HWND parent, unsigned long style )
+  {
+    /* Create the view window, and establish the line height for its font;
+     * if a file was opened before the window existed, show any progress
+     * which the indexer has already made, and allow it to report more.
+     */
+    ChildWindowMaker::Create( id, parent, RegisteredClassName(), style | WS_VSCROLL );
+    TEXTMETRIC metrics; HDC dc = GetDC( AppWindow );
+    HGDIOBJ original = SelectObject( dc, Font );
+    GetTextMetrics( dc, &metrics ); LineHeight = metrics.tmHeight;
+    SelectObject( dc, original ); ReleaseDC( AppWindow, dc );
+    InterlockedExchange( &ProgressPending, 0 );
+    UpdateScrollRange(); InvalidateRect( AppWindow, NULL, TRUE );
+    return AppWindow;
+  }
+
+  bool TextViewWindow::Open( const char *filename )
+  {
+    /* Open a specified file for viewing, (replacing any which is already
+     * open); the file is mapped, but not read, and its line indexer is
+     * started, so this returns immediately, regardless of file size.
+     */
+    Close();
+    File = CreateFile( filename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+	NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL
+      );
+    if( File == INVALID_HANDLE_VALUE ) { File = NULL; return false; }
+
+    LARGE_INTEGER size;
+    FileSize = GetFileSizeEx( File, &size ) ? size.QuadPart : 0;
+    Page = (ULONGLONG **)(calloc( WTK_TEXTVIEW_PAGES, sizeof( ULONGLONG * )));
+    if( (Page == NULL) || ((FileSize > 0)
+    &&  ((Mapping = CreateFileMapping( File, NULL, PAGE_READONLY, 0, 0, NULL )) == NULL))  )
+    {
+      Close(); return false;
+    }
+    /* Should we fail to start the indexer thread, fall back to building
+     * the index synchronously.
+     */
+    if( (Indexer = (HANDLE)(_beginthreadex( NULL, 0, Worker, this, 0, NULL ))) == NULL )
+      Index();
+
+    UpdateScrollRange();
+    if( AppWindow != NULL ) InvalidateRect( AppWindow, NULL, TRUE );
+    return true;
+  }
+
+  void TextViewWindow::Close()
+  {
+    /* Stop the indexer, if it is still running, then release all views
+     * of the current file, and the file itself.
+     */
+    if( Indexer != NULL )
+    {
+      Cancelled = true;
+      WaitForSingleObject( Indexer, INFINITE );
+      CloseHandle( Indexer ); Indexer = NULL;
+    }
+    for( int i = 0; i < WTK_TEXTVIEW_VIEWS; i++ )
+      if( View[i].data != NULL )
+      {
+	UnmapViewOfFile( View[i].data );
+	View[i].data = NULL;
+      }
+    if( Mapping != NULL ) { CloseHandle( Mapping ); Mapping = NULL; }
+    if( File != NULL ) { CloseHandle( File ); File = NULL; }
+    if( Page != NULL )
+    {
+      for( int i = 0; i < WTK_TEXTVIEW_PAGES; i++ ) free( (void *)(Page[i]) );
+      free( (void *)(Page) ); Page = NULL;
+    }
+    FileSize = 0; IndexedLines = 0; ShownLines = 0; TopLine = 0;
+    ProgressPending = 0; Indexed = Cancelled = false;
+    if( AppWindow != NULL ) { UpdateScrollRange(); InvalidateRect( AppWindow, NULL, TRUE ); }
+  }
+
+  unsigned __stdcall TextViewWindow::Worker( void *owner )
+  {
+    /* Thread procedure for the line indexer.
+     */
+    ((TextViewWindow *)(owner))->Index();
+    return 0;
+  }
+
+  static inline
+  bool AppendLine( ULONGLONG **page, unsigned long &count, ULONGLONG offset )
+  {
+    /* Helper to record the offset of one line, within the index, adding
+     * a new page when required; returns false, if the index is full, or
+     * if a new page cannot be allocated.
+     */
+    unsigned long index = count / WTK_TEXTVIEW_PAGE;
+    if( (count % WTK_TEXTVIEW_PAGE) == 0 )
+    {
+      if( (index >= WTK_TEXTVIEW_PAGES)
+      ||  ((page[index] = (ULONGLONG *)(malloc( WTK_TEXTVIEW_PAGE * sizeof( ULONGLONG )))) == NULL)  )
+	return false;
+    }
+    page[index][count++ % WTK_TEXTVIEW_PAGE] = offset;
+    return true;
+  }
+
+  void TextViewWindow::Index()
+  {
+    /* Scan the file, one chunk at a time, through a private view, to
+     * record the offset of every line; after each chunk, the count of
+     * indexed lines is published, and the view window is advised.
+     */
+    unsigned long count = 0;
+    bool ok = (FileSize > 0) && AppendLine( Page, count, 0 );
+    for( ULONGLONG base = 0; ok && (base < FileSize) && ! Cancelled; base += WTK_TEXTVIEW_CHUNK )
+    {
+      size_t size = ((FileSize - base) < WTK_TEXTVIEW_CHUNK)
+	? (size_t)(FileSize - base) : (size_t)(WTK_TEXTVIEW_CHUNK);
+      const char *data = (const char *)(MapViewOfFile( Mapping, FILE_MAP_READ,
+	    (DWORD)(base >> 32), (DWORD)(base), size
+	  ));
+      if( data == NULL ) break;
+
+      size_t i = 0;
+#    ifdef __SSE2__
+      const __m128i newline = _mm_set1_epi8( '\n' );
+      for( ; ok && ((i + 16) <= size); i += 16 )
+      {
+	unsigned int mask = _mm_movemask_epi8( _mm_cmpeq_epi8(
+	      _mm_loadu_si128( (const __m128i *)(data + i) ), newline
+	    ));
+	while( ok && (mask != 0) )
+	{
+	  ULONGLONG next = base + i + __builtin_ctz( mask ) + 1;
+	  if( next < FileSize ) ok = AppendLine( Page, count, next );
+	  mask &= mask - 1;
+	}
+      }
+#    endif
+      for( const char *ref; ok && (i < size)
+	  && ((ref = (const char *)(memchr( data + i, '\n', size - i ))) != NULL); )
+      {
+	ULONGLONG next = base + (i = ref - data + 1);
+	if( next < FileSize ) ok = AppendLine( Page, count, next );
+      }
+      UnmapViewOfFile( data );
+
+      InterlockedExchange( &IndexedLines, count );
+      ReportProgress();
+    }
+    /* The index is complete, (or as complete as it can be); make the
+     * final line available for display.
+     */
+    InterlockedExchange( &IndexedLines, count ); Indexed = true;
+    HWND window = AppWindow;
+    if( window != NULL ) PostMessage( window, WTK_TEXTVIEW_INDEXED, 0, 0 );
+  }
+
+  void TextViewWindow::ReportProgress()
+  {
+    /* Helper, called by the indexer thread, to post a progress report,
+     * unless one is already pending.  A view which has yet to be created,
+     * (e.g. a deferred pane), has no window to which to post; (a NULL
+     * window handle would direct the report to the indexer thread's own
+     * queue, where it would never be handled).  Instead, Create() shows
+     * whatever progress has been made, when the window does exist.
+     */
+    HWND window = AppWindow;
+    if( (window != NULL) && (InterlockedExchange( &ProgressPending, 1 ) == 0)
+    &&  ! PostMessage( window, WTK_TEXTVIEW_INDEXED, 0, 0 )  )
+      InterlockedExchange( &ProgressPending, 0 );
+  }
+
+  unsigned long TextViewWindow::Lines()
+  {
+    /* Helper to determine how many lines may be displayed; until the
+     * index is complete, the last line indexed is incomplete, so is
+     * excluded.
+     */
+    if( Indexed ) return IndexedLines;
+    unsigned long count = IndexedLines;
+    return count ? count - 1 : 0;
+  }
+
+  const char *TextViewWindow::Map( ULONGLONG offset, size_t len )
+  {
+    /* Helper to obtain a pointer to a specified range of bytes, (no
+     * longer than one line), through one of the display views; the least
+     * recently created view is replaced, if none yet covers the range.
+     */
+    for( int i = 0; i < WTK_TEXTVIEW_VIEWS; i++ )
+      if( (View[i].data != NULL) && (offset >= View[i].base)
+      &&  ((offset + len) <= (View[i].base + View[i].size))  )
+	return View[i].data + (size_t)(offset - View[i].base);
+
+    TextViewMapping *view = View + NextView;
+    NextView = (NextView + 1) % WTK_TEXTVIEW_VIEWS;
+    if( view->data != NULL ) UnmapViewOfFile( view->data );
+    view->base = offset - (offset % WTK_TEXTVIEW_CHUNK);
+    view->size = WTK_TEXTVIEW_CHUNK + WTK_TEXTVIEW_OVERLAP;
+    if( (FileSize - view->base) < view->size ) view->size = (size_t)(FileSize - view->base);
+    view->data = (const char *)(MapViewOfFile( Mapping, FILE_MAP_READ,
+	  (DWORD)(view->base >> 32), (DWORD)(view->base), view->size
+	));
+    return (view->data != NULL) ? view->data + (size_t)(offset - view->base) : NULL;
+  }
+
+  long TextViewWindow::Controller( unsigned message, WPARAM w_param, LPARAM l_param )
+  {
+    /* Intercept progress reports from the indexer; when lines within the
+     * visible page become available for the first time, they must be
+     * painted.  All other messages are handled in the usual manner.
+     */
+    if( message == WTK_TEXTVIEW_INDEXED )
+    {
+      InterlockedExchange( &ProgressPending, 0 );
+      if( ShownLines < (TopLine + PageLines + 1) )
+	InvalidateRect( AppWindow, NULL, TRUE );
+      UpdateScrollRange();
+      return 0L;
+    }
+    return ChildWindowMaker::Controller( message, w_param, l_param );
+  }
+
+  void TextViewWindow::UpdateScrollRange()
+  {
+    /* Helper to adjust the vertical scroll bar, to reflect the number of
+     * lines which are currently available for display.
+     */
+    SCROLLINFO info;
+    info.cbSize = sizeof( info );
+    info.fMask = SIF_RANGE | SIF_PAGE | SIF_POS;
+    ShownLines = Lines();
+    info.nMin = 0; info.nMax = (ShownLines > 0x7FFFFFFFUL) ? 0x7FFFFFFF : (int)(ShownLines) - 1;
+    info.nPage = PageLines; info.nPos = TopLine;
+    SetScrollInfo( AppWindow, SB_VERT, &info, TRUE );
+  }
+
+  void TextViewWindow::ScrollTo( unsigned long line )
+  {
+    /* Helper to move a specified line to the top of the view; where
+     * the movement is less than one page, the content which remains
+     * visible is scrolled, so that only the exposed lines are repainted.
+     */
+    unsigned long limit = Lines();
+    limit = (limit > PageLines) ? limit - PageLines : 0;
+    if( line > limit ) line = limit;
+    if( line != TopLine )
+    {
+      long delta = (long)(TopLine) - (long)(line);
+      if( (unsigned long)(labs( delta )) < PageLines )
+	ScrollWindowEx( AppWindow, 0, delta * LineHeight, NULL, NULL, NULL, NULL,
+	    SW_INVALIDATE | SW_ERASE
+	  );
+      else InvalidateRect( AppWindow, NULL, TRUE );
+
+      SCROLLINFO info;
+      info.cbSize = sizeof( info ); info.fMask = SIF_POS;
+      info.nPos = TopLine = line;
+      SetScrollInfo( AppWindow, SB_VERT, &info, TRUE );
+    }
+  }
+
+  long TextViewWindow::OnSize( WPARAM mode, int width, int height )
+  {
+    /* Recompute the number of whole lines which fit the view, and ensure
+     * that the view remains within the scrollable range.
+     */
+    if( LineHeight > 0 ) PageLines = height / LineHeight;
+    UpdateScrollRange(); ScrollTo( TopLine );
+    return 0L;
+  }
+
+  long TextViewWindow::OnVerticalScroll( int code, int position, HWND control )
+  {
+    /* Handle scroll bar actions; for thumb tracking, the 16-bit position
+     * which accompanies the message is inadequate for large files, so the
+     * full 32-bit tracking position is retrieved from the scroll bar.
+     */
+    unsigned long line = TopLine;
+    switch( code )
+    {
+      case SB_LINEUP:	line = line ? line - 1 : 0; break;
+      case SB_LINEDOWN:	line = line + 1; break;
+      case SB_PAGEUP:	line = (line > PageLines) ? line - PageLines : 0; break;
+      case SB_PAGEDOWN:	line = line + PageLines; break;
+      case SB_TOP:	line = 0; break;
+      case SB_BOTTOM:	line = Lines(); break;
+
+      case SB_THUMBTRACK:
+      case SB_THUMBPOSITION:
+	{ SCROLLINFO info;
+	  info.cbSize = sizeof( info ); info.fMask = SIF_TRACKPOS;
+	  GetScrollInfo( AppWindow, SB_VERT, &info );
+	  line = info.nTrackPos;
+	}
+	break;
+
+      default:
+	return 0L;
+    }
+    ScrollTo( line );
+    return 0L;
+  }
+
+  long TextViewWindow::OnPaint()
+  {
+    /* Paint only those lines which intersect the update region; the text
+     * of each is read directly from the mapped file.
+     */
+    PAINTSTRUCT ps; HDC dc = BeginPaint( AppWindow, &ps );
+    if( (LineHeight > 0) && (Page != NULL) )
+    {
+      HGDIOBJ original = SelectObject( dc, Font );
+      SetBkMode( dc, TRANSPARENT );
+      SetTextColor( dc, GetSysColor( COLOR_WINDOWTEXT ) );
+
+      unsigned long lines = Lines();
+      unsigned long line = TopLine + ps.rcPaint.top / LineHeight;
+      unsigned long last = TopLine + (ps.rcPaint.bottom - 1) / LineHeight;
+      for( ; (line <= last) && (line < lines); line++ )
+      {
+	ULONGLONG start = LineOffset( line );
+	ULONGLONG end = ((line + 1) < (unsigned long)(IndexedLines)) ? LineOffset( line + 1 ) : FileSize;
+	size_t len = ((end - start) > WTK_TEXTVIEW_LINE_MAX) ? WTK_TEXTVIEW_LINE_MAX : (size_t)(end - start);
+	const char *text = Map( start, len );
+	if( text == NULL ) break;
+	while( (len > 0) && ((text[len - 1] == '\n') || (text[len - 1] == '\r')) ) --len;
+	TabbedTextOut( dc, 2, (line - TopLine) * LineHeight, text, len, 0, NULL, 0 );
+      }
+      SelectObject( dc, original );
+    }
+    EndPaint( AppWindow, &ps );
+    return 0L;
+  }
+
+  TextViewWindow::~TextViewWindow()
+  {
+    /* Ensure that the indexer has stopped, before the object which it
+     * references ceases to exist.
+     */
+    Close();
+  }
+}
+
+/* $RCSfile$: end of file */
@@ -0,0 +1,103 @@
+/*
+ * wtkthrd.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation of the UIThread class, which
+ * supports secondary user interface threads, each owning its own top level
+ * windows, and running its own message loop.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <process.h>
+#include "wtklite.h"
+
+namespace WTK
+{
+  void UIThread::Start()
+  {
+    /* Create the thread, and wait until it has established its message
+     * queue; a thread which is already running is left undisturbed.
+     */
+    if( IsRunning() ) return;
+    if( Thread != NULL ) { CloseHandle( Thread ); Thread = NULL; }
+
+    if( (Ready = CreateEvent( NULL, TRUE, FALSE, NULL )) == NULL )
+      throw( runtime_error( "Cannot create user interface thread" ) );
+    Thread = (HANDLE)(_beginthreadex( NULL, 0, Entry, this, 0, &ThreadId ));
+    if( Thread != NULL ) WaitForSingleObject( Ready, INFINITE );
+    CloseHandle( Ready ); Ready = NULL;
+    if( Thread == NULL )
+      throw( runtime_error( "Cannot create user interface thread" ) );
+  }
+
+  UIThread::~UIThread()
+  {
+    /* Ensure that the thread has finished, before releasing its handle.
+     */
+    Stop();
+    if( Thread != NULL ) CloseHandle( Thread );
+  }
+
+  unsigned __stdcall UIThread::Entry( void *owner )
+  {
+    /* Thread procedure: PeekMessage() creates the thread's message queue,
+     * (if it does not already exist), before we signal that we are ready;
+     * then delegate to the derived class's implementation of Run().
+     */
+    UIThread *thread = (UIThread *)(owner);
+    MSG message; PeekMessage( &message, NULL, WM_USER, WM_USER, PM_NOREMOVE );
+    SetEvent( thread->Ready );
+    return (unsigned)(thread->ExitCode = thread->Run());
+  }
+
+  void UIThread::Quit( int status )
+  {
+    /* Ask the thread's message loop to terminate, as if its own window
+     * had called PostQuitMessage(); this has no effect on any other thread.
+     */
+    if( IsRunning() ) PostThreadMessage( ThreadId, WM_QUIT, (WPARAM)(status), 0 );
+  }
+
+  bool UIThread::Wait( DWORD timeout )
+  {
+    /* Wait, for no longer than the specified timeout, for the thread
+     * to finish; the thread handle is retained, so that a subsequent
+     * Wait() will also return true.
+     */
+    return (Thread == NULL) || (WaitForSingleObject( Thread, timeout ) == WAIT_OBJECT_0);
+  }
+}
+
+/* $RCSfile$: end of file */
@@ -0,0 +1,283 @@
+/*
+ * wtktimer.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation for the TimerWheel class, which
+ * multiplexes any number of logical timers, (objects of classes derived
+ * from the Timer class), onto a single waitable timer, serviced within
+ * the message loop of a MainWindowMaker object.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include "wtklite.h"
+
+/* Slot index used to identify the list of timers which have expired,
+ * but have not yet been dispatched; it follows the wheel slots proper.
+ */
+#define WTK_TIMER_EXPIRED  WTK_TIMER_SLOTS
+
+/* Tick value used to indicate that the clock is not set.
+ */
+#define WTK_TIMER_IDLE  (~(ULONGLONG)(0))
+
+namespace WTK
+{
+  void Timer::Cancel()
+  {
+    /* Withdraw a pending timer from the wheel by which it is scheduled.
+     */
+    if( Wheel != NULL ) Wheel->Cancel( this );
+  }
+
+  TimerWheel::TimerWheel( unsigned int resolution ): Owner( NULL ),
+  Resolution( resolution ? resolution : 1 ), CurrentTick( 0 ), ArmedTick( WTK_TIMER_IDLE ),
+  PendingCount( 0 )
+  {
+    /* Construct an empty wheel, with ticks at intervals of the specified
+     * resolution, (in milliseconds); all timers which expire within any
+     * one such interval are coalesced.
+     */
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency( &counter ); Frequency = counter.QuadPart;
+    QueryPerformanceCounter( &counter ); Origin = counter.QuadPart;
+    for( unsigned int i = 0; i <= WTK_TIMER_SLOTS; i++ ) Slot[i] = NULL;
+    ResetStatistics();
+
+    /* The clock is a synchronisation timer, so that each signal is
+     * consumed by the wait within the message loop; it is set to signal
+     * only once, at the earliest tick for which any timer is due.
+     */
+    if( (Clock = CreateWaitableTimer( NULL, FALSE, NULL )) == NULL )
+      throw( runtime_error( "Timer wheel initialisation FAILED" ) );
+  }
+
+  void TimerWheel::Attach( MainWindowMaker *owner )
+  {
+    /* Attach the wheel's clock to the message loop, on which all
+     * timer expiry notifications will be dispatched.
+     */
+    (Owner = owner)->AttachMonitor( this );
+  }
+
+  ULONGLONG TimerWheel::Now()
+  {
+    /* Helper to retrieve the time, in milliseconds, since the wheel
+     * was constructed.
+     */
+    LARGE_INTEGER counter; QueryPerformanceCounter( &counter );
+    return (ULONGLONG)(counter.QuadPart - Origin) * 1000 / Frequency;
+  }
+
+  void TimerWheel::Insert( Timer *timer, unsigned int slot )
+  {
+    /* Helper to push a timer on to the head of a specified slot list.
+     */
+    if( (timer->Next = Slot[slot]) != NULL ) timer->Next->Prev = timer;
+    timer->Prev = NULL; Slot[timer->Slot = slot] = timer;
+  }
+
+  void TimerWheel::Remove( Timer *timer )
+  {
+    /* Helper to detach a timer from whichever slot list it is in.
+     */
+    if( timer->Next != NULL ) timer->Next->Prev = timer->Prev;
+    if( timer->Prev != NULL ) timer->Prev->Next = timer->Next;
+    else Slot[timer->Slot] = timer->Next;
+  }
+
+  void TimerWheel::Link( Timer *timer )
+  {
+    /* Helper to add a timer, (for which the expiry time has been set),
+     * to the appropriate slot; its expiry is rounded up to a whole tick,
+     * which must be later than the tick most recently processed.
+     */
+    timer->Tick = (timer->Due + Resolution - 1) / Resolution;
+    if( timer->Tick <= CurrentTick ) timer->Tick = CurrentTick + 1;
+    Insert( timer, (unsigned int)(timer->Tick) & (WTK_TIMER_SLOTS - 1) );
+    timer->Wheel = this; Arm( timer->Tick );
+  }
+
+  void TimerWheel::Unlink( Timer *timer )
+  {
+    /* Helper to withdraw a timer from the wheel; the clock is stopped,
+     * when no further timers remain pending, (otherwise, it is left set,
+     * and if it then signals before any timer is due, OnSignalled() will
+     * simply set it again).
+     */
+    Remove( timer ); timer->Wheel = NULL;
+    if( --PendingCount == 0 )
+    {
+      CancelWaitableTimer( Clock );
+      ArmedTick = WTK_TIMER_IDLE;
+    }
+  }
+
+  void TimerWheel::Arm( ULONGLONG tick )
+  {
+    /* Helper to set the clock to signal at the start of a specified
+     * tick, unless it is already set to signal no later than that.
+     */
+    if( tick < ArmedTick )
+    {
+      ULONGLONG now = Now(), when = tick * Resolution;
+      LARGE_INTEGER due; due.QuadPart = (when > now) ? -10000LL * (LONGLONG)(when - now) : -1LL;
+      SetWaitableTimer( Clock, &due, 0, NULL, NULL, FALSE );
+      ArmedTick = tick;
+    }
+  }
+
+  ULONGLONG TimerWheel::Earliest()
+  {
+    /* Helper to find the earliest tick for which any timer is due; the
+     * slots are visited in expiry order, beginning with that for the tick
+     * after the current tick, so the search ends at the first slot which
+     * holds a timer due within the current revolution of the wheel, (or
+     * after one complete revolution, if all are due later than that).
+     */
+    ULONGLONG earliest = WTK_TIMER_IDLE;
+    for( ULONGLONG tick = CurrentTick + 1;
+	(tick <= CurrentTick + WTK_TIMER_SLOTS) && (tick < earliest); tick++
+      )
+      for( Timer *timer = Slot[(unsigned int)(tick) & (WTK_TIMER_SLOTS - 1)];
+	  timer != NULL; timer = timer->Next
+	)
+	if( timer->Tick < earliest ) earliest = timer->Tick;
+    return earliest;
+  }
+
+  void TimerWheel::Schedule( Timer *timer, unsigned long delay, unsigned long period )
+  {
+    /* Schedule a timer, (first withdrawing it from any wheel in which
+     * it may already be pending), to expire after a specified delay,
+     * and optionally, periodically thereafter.
+     */
+    if( timer->Wheel != NULL ) timer->Wheel->Unlink( timer );
+    if( PendingCount++ == 0 )
+    {
+      /* The wheel is idle; discard any ticks which may have elapsed while
+       * it was stopped; (the clock is set when the timer is linked).
+       */
+      CurrentTick = Now() / Resolution;
+    }
+    timer->Due = Now() + delay;
+    timer->Interval = period;
+    Link( timer );
+  }
+
+  void TimerWheel::OnSignalled()
+  {
+    /* Invoked from the message loop, when the clock signals; this may
+     * be later than the tick for which it was set, if the loop is busy,
+     * so we process all slots which have come due since the previous
+     * call, (but if no timer has come due, we merely set it again).
+     */
+    ULONGLONG now = Now(), target = now / Resolution;
+    ArmedTick = WTK_TIMER_IDLE;
+    if( target <= CurrentTick ) target = CurrentTick;
+
+    /* Move each expired timer to the expiry list; when a complete
+     * revolution of the wheel has elapsed, we need visit each slot
+     * only once.
+     */
+    ULONGLONG ticks = target - CurrentTick;
+    if( ticks > WTK_TIMER_SLOTS ) ticks = WTK_TIMER_SLOTS;
+    while( ticks-- > 0 )
+    {
+      unsigned int slot = (unsigned int)(++CurrentTick) & (WTK_TIMER_SLOTS - 1);
+      for( Timer *timer = Slot[slot], *next; timer != NULL; timer = next )
+      {
+	next = timer->Next;
+	if( timer->Tick <= target )
+	{
+	  Remove( timer );
+	  Insert( timer, WTK_TIMER_EXPIRED );
+	}
+      }
+    }
+    CurrentTick = target;
+
+    /* Dispatch each expired timer in turn, first removing it from the
+     * expiry list, (or rescheduling it, if periodic), since its handler
+     * may cancel, or reschedule, itself or any other timer.
+     */
+    Timer *timer;
+    while( (timer = Slot[WTK_TIMER_EXPIRED]) != NULL )
+    {
+      if( now > timer->Due )
+      {
+	unsigned long drift = (unsigned long)(now - timer->Due);
+	if( drift > PeakDrift ) PeakDrift = drift;
+	TotalDrift += drift;
+      }
+      ++DispatchCount;
+
+      if( timer->Interval > 0 )
+      {
+	/* A periodic timer is rescheduled at its next nominal expiry
+	 * time which is not already past; any missed intervals are not
+	 * replayed.
+	 */
+	Remove( timer );
+	if( (timer->Due += timer->Interval) <= now )
+	  timer->Due += ((now - timer->Due) / timer->Interval + 1) * timer->Interval;
+	Link( timer );
+      }
+      else
+	Unlink( timer );
+
+      timer->OnTimer();
+    }
+
+    /* Finally, set the clock for the earliest tick at which any timer,
+     * (other than those already rescheduled, or scheduled by the handlers
+     * just invoked, for which it has already been set), is due.
+     */
+    if( PendingCount > 0 ) Arm( Earliest() );
+  }
+
+  TimerWheel::~TimerWheel()
+  {
+    /* Withdraw all pending timers, detach from the message loop, and
+     * release the clock.
+     */
+    for( unsigned int i = 0; i <= WTK_TIMER_SLOTS; i++ )
+      for( Timer *timer = Slot[i]; timer != NULL; timer = timer->Next )
+	timer->Wheel = NULL;
+    if( Owner != NULL ) Owner->DetachMonitor( this );
+    CloseHandle( Clock );
+  }
+}
+
+/* $RCSfile$: end of file */
@@ -0,0 +1,383 @@
+/*
+ * wtkview.cpp
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Implementation of a minimal C++ class framework for use with the
+ * Microsoft Windows Application Programming Interface.
+ *
+ * $Id$
+ *
+ * This file provides the implementation for the DataViewEngine class, which
+ * sorts and filters a columnar snapshot of a VirtualListSource on a background
+ * thread, publishing each result as a permutation of source row indices.
+ *
+ * Copyright (C) 2026, MinGW.org Project.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice, this permission notice, and the following
+ * disclaimer shall be included in all copies or substantial portions of
+ * the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ * ---------------------------------------------------------------------------
+ *
+ */
+#define WIN32_LEAN_AND_MEAN
+
+#include <ctype.h>
+#include <string.h>
+#include <process.h>
+#include "wtklite.h"
+
+/* The interval, in rows, at which a running evaluation checks whether
+ * it has been superseded by a newer query.
+ */
+#define WTK_DATAVIEW_POLL  4096
+
+namespace WTK
+{
+  struct DataViewColumn
+  {
+    /* The snapshot of each column comprises a single pool of all cell
+     * text, as NUL terminated strings, with a table of offsets into it,
+     * indexed by source row.
+     */
+    char *text;
+    unsigned long *offset;
+  };
+
+  struct DataViewResult
+  {
+    /* The outcome of an evaluated query; the row table is allocated
+     * with as many entries as there were rows in the snapshot.
+     */
+    LONG generation;
+    unsigned long count;
+    unsigned long row[1];
+  };
+
+  DataViewEngine::DataViewEngine( int columns ):
+  ColumnCount( columns ), RowTotal( 0 ), Column( NULL ), Current( NULL ),
+  Published( NULL ), SortColumn( -1 ), FilterColumn( -1 ), Descending( false ),
+  Filter( NULL ), Window( NULL ), Message( 0 ), Generation( 0 ),
+  Terminate( false ), Thread( NULL )
+  {
+    /* Start the worker thread, initially idle, awaiting a query.
+     */
+    InitializeCriticalSection( &Guard ); InitializeCriticalSection( &Lock );
+    if( (Wakeup = CreateEvent( NULL, FALSE, FALSE, NULL )) != NULL )
+      Thread = (HANDLE)(_beginthreadex( NULL, 0, Worker, this, 0, NULL ));
+    if( Thread == NULL )
+    {
+      if( Wakeup != NULL ) CloseHandle( Wakeup );
+      DeleteCriticalSection( &Guard ); DeleteCriticalSection( &Lock );
+      throw( runtime_error( "Cannot start data view worker thread" ) );
+    }
+  }
+
+  void DataViewEngine::Attach( HWND window, unsigned int message )
+  {
+    /* Nominate the window, and message, to be used to announce the
+     * completion of each query.
+     */
+    Window = window; Message = message;
+  }
+
+  void DataViewEngine::Release()
+  {
+    /* Helper to discard the current snapshot, and any results derived
+     * from it; the caller must hold the data lock.
+     */
+    if( Column != NULL )
+    {
+      for( int i = 0; i < ColumnCount; i++ )
+      {
+	free( (void *)(Column[i].text) );
+	free( (void *)(Column[i].offset) );
+      }
+      free( (void *)(Column) ); Column = NULL;
+    }
+    free( InterlockedExchangePointer( (void * volatile *)(&Published), NULL ) );
+    free( (void *)(Current) ); Current = NULL;
+    RowTotal = 0;
+  }
+
+  void DataViewEngine::Load( VirtualListSource *source )
+  {
+    /* Take a snapshot of the entire content of a specified data source;
+     * any query in progress is abandoned, but the most recently submitted
+     * query is resubmitted, when the snapshot is complete.
+     */
+    InterlockedIncrement( &Generation );
+    EnterCriticalSection( &Lock );
+    Release();
+
+    unsigned long rows = source->RowCount();
+    bool complete = (Column = (DataViewColumn *)(calloc( ColumnCount, sizeof( DataViewColumn )))) != NULL;
+    for( int i = 0; complete && (i < ColumnCount); i++ )
+    {
+      /* Copy each column in turn, growing its text pool as required.
+       */
+      size_t size = 0, used = 0;
+      Column[i].offset = (unsigned long *)(malloc( (rows + 1) * sizeof( unsigned long )));
+      complete = (Column[i].offset != NULL);
+      for( unsigned long row = 0; complete && (row < rows); row++ )
+      {
+	if( (size - used) < WTK_LIST_TEXT_MAX )
+	{
+	  char *pool = (char *)(realloc( Column[i].text, size += size + (WTK_LIST_TEXT_MAX << 4) ));
+	  if( (complete = (pool != NULL)) == false ) break;
+	  Column[i].text = pool;
+	}
+	*(Column[i].text + used) = '\0';
+	source->FetchText( row, i, Column[i].text + used, WTK_LIST_TEXT_MAX );
+	Column[i].text[used + WTK_LIST_TEXT_MAX - 1] = '\0';
+	Column[i].offset[row] = used; used += strlen( Column[i].text + used ) + 1;
+      }
+    }
+    if( ! complete )
+    {
+      /* We were unable to allocate sufficient memory to accommodate
+       * the snapshot; discard whatever part of it we did manage to copy.
+       */
+      Release(); LeaveCriticalSection( &Lock );
+      throw( runtime_error( "Insufficient memory" ) );
+    }
+    RowTotal = rows;
+    LeaveCriticalSection( &Lock );
+
+    /* Until the resubmitted query completes, the view presents the
+     * snapshot in its original order.
+     */
+    char *filter = Filter; Filter = NULL;
+    Query( SortColumn, Descending, filter, FilterColumn );
+    free( (void *)(filter) );
+  }
+
+  unsigned long DataViewEngine::Query
+  ( int column, bool descending, const char *filter, int filter_column )
+  {
+    /* Record the parameters for a new query, superseding any which may
+     * still be in progress, then wake the worker thread to evaluate it.
+     */
+    char *text = NULL;
+    if( (filter != NULL) && (*filter != '\0')
+    &&  ((text = (char *)(malloc( strlen( filter ) + 1 ))) != NULL)  )
+      for( char *ref = text; (*ref = tolower( (unsigned char)(*filter) )) != '\0'; ++ref, ++filter )
+	;
+    EnterCriticalSection( &Guard );
+    free( (void *)(Filter) ); Filter = text;
+    SortColumn = (column < ColumnCount) ? column : -1;
+    FilterColumn = (filter_column < ColumnCount) ? filter_column : -1;
+    Descending = descending;
+    unsigned long generation = InterlockedIncrement( &Generation );
+    LeaveCriticalSection( &Guard );
+    SetEvent( Wakeup );
+    return generation;
+  }
+
+  unsigned __stdcall DataViewEngine::Worker( void *owner )
+  {
+    /* Thread procedure for the worker; it sleeps until a query is
+     * submitted, then evaluates the most recent one, and publishes its
+     * result, unless it has been superseded in the meantime.
+     */
+    DataViewEngine *view = (DataViewEngine *)(owner);
+    while( (WaitForSingleObject( view->Wakeup, INFINITE ) == WAIT_OBJECT_0)
+    &&     ! view->Terminate  )
+    {
+      EnterCriticalSection( &(view->Guard) );
+      LONG generation = view->Generation;
+      int column = view->SortColumn, filter_column = view->FilterColumn;
+      bool descending = view->Descending;
+      char *filter = NULL;
+      if( (view->Filter != NULL)
+      &&  ((filter = (char *)(malloc( strlen( view->Filter ) + 1 ))) != NULL)  )
+	strcpy( filter, view->Filter );
+      LeaveCriticalSection( &(view->Guard) );
+
+      EnterCriticalSection( &(view->Lock) );
+      DataViewResult *result = view->Evaluate( generation, column, descending, filter, filter_column );
+      LeaveCriticalSection( &(view->Lock) );
+      free( (void *)(filter) );
+
+      if( result != NULL )
+      {
+	/* Publish the result, discarding any predecessor which the user
+	 * interface thread did not collect, then announce it.
+	 */
+	free( InterlockedExchangePointer( (void * volatile *)(&(view->Published)), result ) );
+	if( view->Window != NULL )
+	  PostMessage( view->Window, view->Message, generation, 0 );
+      }
+    }
+    return 0;
+  }
+
+  int DataViewEngine::Compare( int column, unsigned long a, unsigned long b )
+  {
+    /* Helper to compare the text of two cells, within a specified column;
+     * the comparison is case insensitive.
+     */
+    const char *text = Column[column].text;
+    return stricmp( text + Column[column].offset[a], text + Column[column].offset[b] );
+  }
+
+  bool DataViewEngine::Matches( unsigned long row, const char *filter, int column )
+  {
+    /* Helper to determine whether a specified row satisfies a filter,
+     * (which has been folded to lower case), in either the specified
+     * column, or any column, if none is specified.
+     */
+    int last = (column < 0) ? ColumnCount - 1 : column;
+    for( int i = (column < 0) ? 0 : column; i <= last; i++ )
+      for( const char *text = Column[i].text + Column[i].offset[row]; *text; ++text )
+      {
+	const char *ref = filter, *cmp = text;
+	while( *ref && (tolower( (unsigned char)(*cmp) ) == *ref) ) ++ref, ++cmp;
+	if( *ref == '\0' ) return true;
+      }
+    return false;
+  }
+
+  DataViewResult *DataViewEngine::Evaluate
+  ( LONG generation, int column, bool descending, const char *filter, int filter_column )
+  {
+    /* Helper, called by the worker thread with the data lock held, to
+     * evaluate one query; returns NULL, if the query is superseded before
+     * its evaluation is complete, or if memory is exhausted.
+     */
+    DataViewResult *result = (DataViewResult *)(malloc(
+	sizeof( DataViewResult ) + RowTotal * sizeof( unsigned long )
+      ));
+    if( result == NULL ) return NULL;
+    result->generation = generation; result->count = 0;
+
+    /* First, collect the indices of all rows which satisfy the filter...
+     */
+    for( unsigned long row = 0; row < RowTotal; row++ )
+    {
+      if( ((row % WTK_DATAVIEW_POLL) == 0) && (Generation != generation) )
+      { free( (void *)(result) ); return NULL; }
+      if( (filter == NULL) || Matches( row, filter, filter_column ) )
+	result->row[result->count++] = row;
+    }
+    if( (column >= 0) && (result->count > 1) )
+    {
+      /* ...then sort them, using a bottom up merge sort, which is stable,
+       * (so rows with equal keys retain their source order), and which
+       * offers a convenient opportunity to abandon a superseded query,
+       * at the end of each run.
+       */
+      unsigned long count = result->count;
+      unsigned long *buf = (unsigned long *)(malloc( count * sizeof( unsigned long )));
+      if( buf == NULL ) { free( (void *)(result) ); return NULL; }
+      unsigned long *src = result->row, *dst = buf;
+      for( unsigned long width = 1; width < count; width <<= 1 )
+      {
+	for( unsigned long lo = 0; lo < count; lo += width << 1 )
+	{
+	  if( Generation != generation )
+	  { free( (void *)(buf) ); free( (void *)(result) ); return NULL; }
+
+	  unsigned long mid = lo + width, hi = mid + width;
+	  if( mid > count ) mid = count;
+	  if( hi > count ) hi = count;
+	  unsigned long i = lo, j = mid, k = lo;
+	  while( (i < mid) && (j < hi) )
+	  {
+	    int cmp = Compare( column, src[j], src[i] );
+	    dst[k++] = ((descending ? -cmp : cmp) < 0) ? src[j++] : src[i++];
+	  }
+	  while( i < mid ) dst[k++] = src[i++];
+	  while( j < hi ) dst[k++] = src[j++];
+	}
+	unsigned long *tmp = src; src = dst; dst = tmp;
+      }
+      if( src != result->row )
+	memcpy( result->row, src, count * sizeof( unsigned long ) );
+      free( (void *)(buf) );
+    }
+    return result;
+  }
+
+  bool DataViewEngine::Collect()
+  {
+    /* Called on the user interface thread, to adopt the most recently
+     * published result; returns false, if there is none, or if it has
+     * been superseded since publication.
+     */
+    DataViewResult *result = (DataViewResult *)(InterlockedExchangePointer(
+	(void * volatile *)(&Published), NULL
+      ));
+    if( (result != NULL) && (result->generation == Generation) )
+    {
+      free( (void *)(Current) ); Current = result;
+      return true;
+    }
+    free( (void *)(result) );
+    return false;
+  }
+
+  unsigned long DataViewEngine::RowCount()
+  {
+    /* Until the first query result is collected, the view presents the
+     * entire snapshot, in its original order.
+     */
+    return (Current != NULL) ? Current->count : RowTotal;
+  }
+
+  unsigned long DataViewEngine::SourceRow( unsigned long row )
+  {
+    /* Map a row index within the view, to the corresponding index within
+     * the underlying data source.
+     */
+    return (Current != NULL) ? Current->row[row] : row;
+  }
+
+  void DataViewEngine::FetchText
+  ( unsigned long row, int column, char *buf, size_t len )
+  {
+    /* Retrieve cell text from the snapshot, for presentation in a list
+     * view, at the row position assigned by the current permutation.
+     */
+    if( (row < RowCount()) && (column >= 0) && (column < ColumnCount) && (len > 0) )
+    {
+      row = SourceRow( row );
+      strncpy( buf, Column[column].text + Column[column].offset[row], len );
+      buf[len - 1] = '\0';
+    }
+    else if( len > 0 ) *buf = '\0';
+  }
+
+  DataViewEngine::~DataViewEngine()
+  {
+    /* Abandon any query in progress, and stop the worker thread, before
+     * releasing all resources.
+     */
+    Terminate = true;
+    InterlockedIncrement( &Generation ); SetEvent( Wakeup );
+    WaitForSingleObject( Thread, INFINITE );
+    CloseHandle( Thread ); CloseHandle( Wakeup );
+    Release(); free( (void *)(Filter) );
+    DeleteCriticalSection( &Guard ); DeleteCriticalSection( &Lock );
+  }
+}
+
+/* $RCSfile$: end of file */